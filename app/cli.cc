@@ -31,6 +31,17 @@ void hide_args() {
   }
 }
 
+/// @return The mode selected with `-profile-generate[=folder]` or `-profile-use[=path]`.
+Options::ProfileOptions get_profile_opts(cl::opt<std::string>& generate, cl::opt<std::string>& use) {
+  if (generate.getNumOccurrences() && use.getNumOccurrences()) {
+    throw SNError(Error::ARGUMENT_ERROR, "-profile-generate and -profile-use can't be used at the same time");
+  }
+
+  if (generate.getNumOccurrences()) return {Options::ProfileOptions::GENERATE, generate};
+  if (use.getNumOccurrences()) return {Options::ProfileOptions::USE, use};
+  return {};
+}
+
 void register_build_opts(Options::BuildOptions& options, std::string mode, argsVector& args) {
   cl::OptionCategory buildCategory(mode == "build" ? "Build Options" : "Run Options");
 
@@ -50,10 +61,22 @@ void register_build_opts(Options::BuildOptions& options, std::string mode, argsV
   cl::opt<bool> silent("silent", cl::desc("Silent mode"), cl::cat(buildCategory));
   cl::opt<std::string> file("file", cl::desc("File to compile"), cl::cat(buildCategory));
   cl::opt<bool> no_progress("no-progress", cl::desc("Disable progress bar"), cl::cat(buildCategory));
+  cl::opt<unsigned> jobs("jobs", cl::desc("Number of threads used for code generation (0 = one per core)"), cl::init(1), cl::cat(buildCategory));
+  cl::opt<bool> cache_objects("cache-objects", cl::desc("Reuse the object files of modules whose generated code did not change since the previous build"), cl::cat(buildCategory));
+  cl::opt<bool> time_trace("time-trace", cl::desc("Write a Chrome trace (chrome://tracing) of where compile time is spent"), cl::cat(buildCategory));
+  cl::opt<std::string> time_trace_file("time-trace-file", cl::desc("Output file for -time-trace (default: .sn/time-trace.json)"), cl::cat(buildCategory));
+  cl::opt<bool> system_linker("system-linker", cl::desc("Spawn the system linker instead of linking in-process with LLD"), cl::cat(buildCategory));
+  cl::opt<bool> watch("watch", cl::desc("Build again (reusing cached objects) every time a source file changes"), cl::cat(buildCategory));
+  cl::opt<std::string> target_cpu("target-cpu", cl::desc("CPU to generate code for (\"native\" = this machine's)"), cl::cat(buildCategory));
+  cl::opt<std::string> profile_generate("profile-generate", cl::desc("Instrument the program to write a profile into the given folder (default: .sn/profile) when it exits"), cl::ValueOptional, cl::cat(buildCategory));
+  cl::opt<std::string> profile_use("profile-use", cl::desc("Optimize using the profiles (.profraw/.profdata) in the given folder or file (default: .sn/profile)"), cl::ValueOptional, cl::cat(buildCategory));
+  cl::opt<std::string> passes("passes", cl::desc("Custom optimization pipeline, replaces the default one (same syntax as 'opt -passes')"), cl::cat(buildCategory));
+  cl::opt<std::string> target_features("target-features", cl::desc("Comma separated CPU features to enable or disable (e.g. \"+avx2,-fma\", \"native\")"), cl::cat(buildCategory));
   
   cl::alias _silent("s", cl::aliasopt(silent), cl::desc("Alias for -silent"), cl::cat(buildCategory));
   cl::alias _no_progress("np", cl::aliasopt(no_progress), cl::desc("Alias for -no-progress"), cl::cat(buildCategory));
   cl::alias _file("f", cl::aliasopt(file), cl::desc("Alias for -file"), cl::cat(buildCategory));
+  cl::alias _jobs("j", cl::aliasopt(jobs), cl::desc("Alias for -jobs"), cl::cat(buildCategory));
   
   if (mode == "build") {
     auto test = cl::opt<bool>("test", cl::desc("Builds the project for testing"), cl::cat(buildCategory));
@@ -80,6 +103,15 @@ void register_build_opts(Options::BuildOptions& options, std::string mode, argsV
     options.silent = silent;
     options.file = file;
     options.no_progress = no_progress;
+    options.jobs = jobs;
+    options.cacheObjects = cache_objects;
+    options.time_trace = time_trace;
+    options.time_trace_file = time_trace_file;
+    options.system_linker = system_linker;
+    options.watch = watch;
+    options.target = {target_cpu, target_features};
+    options.profile = get_profile_opts(profile_generate, profile_use);
+    options.passes = passes;
 
     options.is_test = test;
     options.is_bench = bench;
@@ -93,6 +125,15 @@ void register_build_opts(Options::BuildOptions& options, std::string mode, argsV
   options.silent = silent;
   options.file = file;
   options.no_progress = no_progress;
+  options.jobs = jobs;
+  options.cacheObjects = cache_objects;
+  options.time_trace = time_trace;
+  options.time_trace_file = time_trace_file;
+  options.system_linker = system_linker;
+  options.watch = watch;
+  options.target = {target_cpu, target_features};
+  options.profile = get_profile_opts(profile_generate, profile_use);
+  options.passes = passes;
 }
 
 void run(Options& opts, argsVector& args) {
@@ -132,15 +173,25 @@ void test(Options& opts, argsVector& args) {
 
   cl::opt<bool> silent("silent", cl::desc("Silent mode"), cl::cat(buildCategory));
   cl::opt<bool> no_progress("no-progress", cl::desc("Disable progress bar"), cl::cat(buildCategory));
+  cl::opt<unsigned> jobs("jobs", cl::desc("Number of tests executed at the same time (0 = one per core)"), cl::init(0), cl::cat(buildCategory));
+  cl::opt<unsigned> timeout("timeout", cl::desc("Seconds a test can run before it's considered failed (0 = no timeout)"), cl::init(0), cl::cat(buildCategory));
+  cl::opt<std::string> filter("filter", cl::desc("Only run the tests whose name contains the given string"), cl::cat(buildCategory));
+  cl::opt<std::string> output("output", cl::desc("File where the results are written (JUnit if it ends with .xml, JSON otherwise)"), cl::cat(buildCategory));
 
   cl::alias _silent("s", cl::aliasopt(silent), cl::desc("Alias for -silent"), cl::cat(buildCategory));
   cl::alias _no_progress("np", cl::aliasopt(no_progress), cl::desc("Alias for -no-progress"), cl::cat(buildCategory));
+  cl::alias _jobs("j", cl::aliasopt(jobs), cl::desc("Alias for -jobs"), cl::cat(buildCategory));
+  cl::alias _output("o", cl::aliasopt(output), cl::desc("Alias for -output"), cl::cat(buildCategory));
 
   parse_args(args);
 
   opts.test_opts.opt = opt;
   opts.test_opts.silent = silent;
   opts.test_opts.no_progress = no_progress;
+  opts.test_opts.jobs = jobs;
+  opts.test_opts.timeout = timeout;
+  opts.test_opts.filter = filter;
+  opts.test_opts.output = output;
 }
 
 void init(Options& opts, argsVector& args) {
@@ -173,16 +224,37 @@ void docs(Options& opts, argsVector& args) {
   cl::opt<bool> silent("silent", cl::desc("Silent mode"), cl::cat(docsCategory));
   cl::opt<bool> no_progress("no-progress", cl::desc("Disable progress bar"), cl::cat(docsCategory));
   cl::opt<std::string> base("base", cl::desc("Base URL"), cl::cat(docsCategory));
+  cl::opt<unsigned> jobs("jobs", cl::desc("Number of modules documented at the same time (0 = one per core)"), cl::init(0), cl::cat(docsCategory));
+  cl::opt<bool> force("force", cl::desc("Generate every page again, even if its module didn't change"), cl::cat(docsCategory));
 
   cl::alias _silent("s", cl::aliasopt(silent), cl::desc("Alias for -silent"), cl::cat(docsCategory));
   cl::alias _no_progress("np", cl::aliasopt(no_progress), cl::desc("Alias for -no-progress"), cl::cat(docsCategory));
   cl::alias _base("b", cl::aliasopt(base), cl::desc("Alias for -base"), cl::cat(docsCategory));
+  cl::alias _jobs("j", cl::aliasopt(jobs), cl::desc("Alias for -jobs"), cl::cat(docsCategory));
 
   parse_args(args);
 
   opts.docs_opts.silent = silent;
   opts.docs_opts.no_progress = no_progress;
   opts.docs_opts.base = base;
+  opts.docs_opts.jobs = jobs;
+  opts.docs_opts.force = force;
+}
+
+void server(Options& opts, argsVector& args) {
+  hide_args();
+
+  cl::OptionCategory serverCategory("Server Options");
+
+  cl::opt<bool> silent("silent", cl::desc("Silent mode"), cl::cat(serverCategory));
+  cl::opt<bool> stop("stop", cl::desc("Stop the running server"), cl::cat(serverCategory));
+
+  cl::alias _silent("s", cl::aliasopt(silent), cl::desc("Alias for -silent"), cl::cat(serverCategory));
+
+  parse_args(args);
+
+  opts.server_opts.silent = silent;
+  opts.server_opts.stop = stop;
 }
 
 void bench(Options& opts, argsVector& args) {
@@ -205,15 +277,24 @@ void bench(Options& opts, argsVector& args) {
 
   cl::opt<bool> silent("silent", cl::desc("Silent mode"), cl::cat(benchCategory));
   cl::opt<bool> no_progress("no-progress", cl::desc("Disable progress bar"), cl::cat(benchCategory));
+  cl::opt<unsigned> samples("samples", cl::desc("Number of samples taken for each benchmark"), cl::init(0), cl::cat(benchCategory));
+  cl::opt<double> threshold("threshold", cl::desc("Change (in %) compared to the baseline considered a regression"), cl::init(0), cl::cat(benchCategory));
+  cl::opt<std::string> output("output", cl::desc("File where the results are written (JSON)"), cl::cat(benchCategory));
+  cl::opt<std::string> baseline("baseline", cl::desc("Results of a previous run to compare against (JSON)"), cl::cat(benchCategory));
 
   cl::alias _silent("s", cl::aliasopt(silent), cl::desc("Alias for -silent"), cl::cat(benchCategory));
   cl::alias _no_progress("np", cl::aliasopt(no_progress), cl::desc("Alias for -no-progress"), cl::cat(benchCategory));
+  cl::alias _output("o", cl::aliasopt(output), cl::desc("Alias for -output"), cl::cat(benchCategory));
 
   parse_args(args);
 
   opts.bench_opts.opt = opt;
   opts.bench_opts.silent = silent;
   opts.bench_opts.no_progress = no_progress;
+  opts.bench_opts.samples = samples;
+  opts.bench_opts.threshold = threshold;
+  opts.bench_opts.output = output;
+  opts.bench_opts.baseline = baseline;
 
 }
 
@@ -260,6 +341,7 @@ Options CLI::parse() {
     cl::SubCommand init("init", "Initialize a Snowball project");
     cl::SubCommand docs("docs", "Generate documentation for a Snowball project");
     cl::SubCommand bench("bench", "Benchmark a Snowball program");
+    cl::SubCommand server("server", "Run a compiler server that speeds up the next commands");
 
     cli::modes::parse_args(args);
     cl::PrintHelpMessage();
@@ -283,6 +365,9 @@ Options CLI::parse() {
   } else if (mode == "bench") {
     opts.command = Options::BENCH;
     cli::modes::bench(opts, args);
+  } else if (mode == "server") {
+    opts.command = Options::SERVER;
+    cli::modes::server(opts, args);
   } else {
     throw SNError(Error::ARGUMENT_ERROR, FMT("Invalid command: %s", mode.c_str()));
   }
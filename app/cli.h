@@ -29,6 +29,26 @@ struct Options {
     OPTIMIZE_Oz = 0x05
   };
 
+  // CPU the generated code is tuned for and the features it may use.
+  // "native" stands for the ones of the machine compiling.
+  struct TargetOptions {
+    std::string cpu = "";
+    std::string features = "";
+  };
+
+  // Profile guided optimization. Programs built with `GENERATE` write a
+  // profile into `path` (a folder) when they exit, builds with `USE`
+  // optimize using the profiles found in `path`.
+  struct ProfileOptions {
+    enum Mode
+    {
+      NONE,
+      GENERATE,
+      USE
+    } mode = NONE;
+    std::string path = "";
+  };
+
   struct BuildOptions {
     bool is_test = false;
     bool is_bench = false;
@@ -39,6 +59,15 @@ struct Options {
     std::string file = "";
     std::string output = "";
     bool no_progress = false;
+    unsigned jobs = 1;
+    bool cacheObjects = false;
+    bool time_trace = false;
+    std::string time_trace_file = "";
+    bool system_linker = false;
+    bool watch = false;
+    TargetOptions target;
+    ProfileOptions profile;
+    std::string passes = "";
   } build_opts;
 
   struct RunOptions : BuildOptions {
@@ -50,12 +79,22 @@ struct Options {
     bool silent = false;
     bool no_progress = false;
     Optimization opt = OPTIMIZE_O1;
+
+    unsigned jobs = 0;
+    unsigned timeout = 0;
+    std::string filter = "";
+    std::string output = "";
   } test_opts;
 
   struct BenchmarkOptions {
     bool silent = false;
     bool no_progress = false;
     Optimization opt = OPTIMIZE_O1;
+
+    unsigned samples = 0;
+    double threshold = 0;
+    std::string output = "";
+    std::string baseline = "";
   } bench_opts;
 
   struct InitOptions {
@@ -71,10 +110,17 @@ struct Options {
   struct DocsOptions {
     bool silent = false;
     bool no_progress = false;
+    bool force = false;
 
+    unsigned jobs = 0;
     std::string base = "";
   } docs_opts;
 
+  struct ServerOptions {
+    bool silent = false;
+    bool stop = false;
+  } server_opts;
+
   enum Command
   {
     UNKNOWN = -1,
@@ -85,6 +131,7 @@ struct Options {
     INIT,
     DOCS,
     BENCH,
+    SERVER,
   } command = UNKNOWN;
 };
 
@@ -99,6 +146,7 @@ void test(Options& opts, argsVector& args);
 void init(Options& opts, argsVector& args);
 void docs(Options& opts, argsVector& args);
 void bench(Options& opts, argsVector& args);
+void server(Options& opts, argsVector& args);
 
 } // namespace modes
 } // namespace cli
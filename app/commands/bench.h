@@ -87,6 +87,14 @@ int bench(app::Options::BenchmarkOptions p_opts) {
     Logger::message("Running", FMT("benchmarks (%s)", filename.c_str()));
   }
 
+  // Configuration for the runtime's benchmark harness
+  std::string results = p_opts.output.empty() ? (compiler->configFolder / "bench" / "results.json").string() : p_opts.output;
+  if (p_opts.output.empty()) fs::create_directories(compiler->configFolder / "bench");
+  setenv("SN_BENCH_OUTPUT", results.c_str(), 1);
+  if (!p_opts.baseline.empty()) setenv("SN_BENCH_BASELINE", p_opts.baseline.c_str(), 1);
+  if (p_opts.samples > 0) setenv("SN_BENCH_SAMPLES", std::to_string(p_opts.samples).c_str(), 1);
+  if (p_opts.threshold > 0) setenv("SN_BENCH_THRESHOLD", std::to_string(p_opts.threshold).c_str(), 1);
+
   char* args[] = {strdup(output.c_str()), NULL};
   int result = execvp(args[0], args);
 
@@ -4,6 +4,7 @@
 #include "constants.h"
 #include "errors.h"
 #include "utils/utils.h"
+#include "watch.h"
 #include "vendor/toml.hpp"
 
 #include <chrono>
@@ -30,6 +31,11 @@ int build(app::Options::BuildOptions p_opts) {
     filename = parsed_config["package"]["main"].value_or<std::string>((fs::current_path() / "src" / "main.sn"));
     package_name = (std::string)(parsed_config["package"]["name"].value_or<std::string>("<anonnimus>"));
     package_version = parsed_config["package"]["version"].value_or<std::string>("<unknown>");
+    // The command line takes precedence over the project's configuration
+    if (p_opts.target.cpu.empty())
+      p_opts.target.cpu = parsed_config["build"]["target-cpu"].value_or<std::string>("");
+    if (p_opts.target.features.empty())
+      p_opts.target.features = parsed_config["build"]["target-features"].value_or<std::string>("");
   }
 
   std::ifstream ifs(filename);
@@ -71,6 +77,13 @@ int build(app::Options::BuildOptions p_opts) {
             FMT("%s v%s [%s%s%s]", package_name.c_str(), package_version.c_str(), BOLD, build_type.c_str(), RESET)
     );
 
+  if (p_opts.watch) {
+    auto opts = p_opts;
+    opts.watch = false;
+    opts.cacheObjects = true;
+    app::watch::watch([=] { return build(opts); }, filename, p_opts.silent);
+  }
+
   std::string content((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
 
   // TODO: check for output
@@ -79,6 +92,13 @@ int build(app::Options::BuildOptions p_opts) {
   std::string output = _SNOWBALL_OUT_DEFAULT(package_name, p_opts.emit_type, !compiler->getGlobalContext()->isDynamic);
   if (!p_opts.output.empty()) { output = p_opts.output; }
   compiler->setOptimization(p_opts.opt);
+  compiler->setCodegenJobs(p_opts.jobs);
+  compiler->setCacheObjects(p_opts.cacheObjects);
+  compiler->setSystemLinker(p_opts.system_linker);
+  compiler->setTarget(p_opts.target);
+  compiler->setProfile(p_opts.profile);
+  compiler->setPassPipeline(p_opts.passes);
+  if (p_opts.time_trace) compiler->enableTimeTrace(p_opts.time_trace_file);
   if (p_opts.is_test) { compiler->enable_tests(); }
 
   auto start = high_resolution_clock::now();
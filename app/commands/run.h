@@ -5,6 +5,7 @@
 #include "utils/logger.h"
 #include "utils/utils.h"
 #include "vendor/toml.hpp"
+#include "watch.h"
 
 #include <stddef.h>
 #include <unistd.h>
@@ -23,6 +24,11 @@ int run(app::Options::RunOptions p_opts) {
             (std::string
             )(parsed_config["package"]["main"].value_or<std::string>((fs::current_path() / "src" / "main.sn"))) :
             p_opts.file;
+    // The command line takes precedence over the project's configuration
+    if (p_opts.target.cpu.empty())
+      p_opts.target.cpu = parsed_config["build"]["target-cpu"].value_or<std::string>("");
+    if (p_opts.target.features.empty())
+      p_opts.target.features = parsed_config["build"]["target-features"].value_or<std::string>("");
   }
 
   std::ifstream ifs(filename);
@@ -35,18 +41,45 @@ int run(app::Options::RunOptions p_opts) {
     return EXIT_FAILURE;
   }
 
-  std::string content((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
+  if (p_opts.jit && p_opts.profile.mode == Options::ProfileOptions::GENERATE) {
+    // The profile runtime is only linked into executables
+    throw SNError(Error::ARGUMENT_ERROR, "-profile-generate can't be used alongside -jit");
+  }
 
-  // TODO: check for output
-  std::string output =
-          fs::current_path() / _SNOWBALL_OUT_DEFAULT("snowball-output", Options::EmitType::EXECUTABLE, false);
+  if (p_opts.watch) {
+    auto opts = p_opts;
+    opts.watch = false;
+    opts.cacheObjects = true;
+    app::watch::watch([=] { return run(opts); }, filename, p_opts.silent);
+  }
+
+  std::string content((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
 
   auto compiler = new Compiler(content, filename);
   compiler->initialize();
   compiler->setOptimization(p_opts.opt);
+  compiler->setCodegenJobs(p_opts.jobs);
+  compiler->setCacheObjects(p_opts.cacheObjects);
+  compiler->setSystemLinker(p_opts.system_linker);
+  compiler->setTarget(p_opts.target);
+  compiler->setProfile(p_opts.profile);
+  compiler->setPassPipeline(p_opts.passes);
+  if (p_opts.time_trace) compiler->enableTimeTrace(p_opts.time_trace_file);
 
   // TODO: false if --no-output is passed
   compiler->compile(p_opts.no_progress || p_opts.silent);
+
+  if (p_opts.jit) {
+    std::vector<std::string> args = {filename};
+    args.insert(args.end(), p_opts.progArgs.begin(), p_opts.progArgs.end());
+    int result = compiler->executeJIT(args);
+    compiler->cleanup();
+    return result;
+  }
+
+  // TODO: check for output
+  std::string output =
+          fs::current_path() / _SNOWBALL_OUT_DEFAULT("snowball-output", Options::EmitType::EXECUTABLE, false);
   compiler->emitBinary(output, false);
 
   compiler->cleanup();
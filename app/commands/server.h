@@ -0,0 +1,18 @@
+#include "cli.h"
+#include "../server.h"
+
+#ifndef __SNOWBALL_SERVER_CMD_H_
+#define __SNOWBALL_SERVER_CMD_H_
+
+namespace snowball {
+namespace app {
+namespace commands {
+int server(app::Options::ServerOptions p_opts, app::server::Handler handler) {
+  if (p_opts.stop) return app::server::stop(p_opts.silent);
+  return app::server::serve(handler, p_opts.silent);
+}
+} // namespace commands
+} // namespace app
+} // namespace snowball
+
+#endif // __SNOWBALL_SERVER_CMD_H_
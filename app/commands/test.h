@@ -87,6 +87,12 @@ int test(app::Options::TestOptions p_opts) {
     Logger::message("Running", FMT("unittests (%s)", filename.c_str()));
   }
 
+  // Configuration for the runtime's test runner
+  if (p_opts.jobs > 0) setenv("SN_TEST_JOBS", std::to_string(p_opts.jobs).c_str(), 1);
+  if (p_opts.timeout > 0) setenv("SN_TEST_TIMEOUT", std::to_string(p_opts.timeout).c_str(), 1);
+  if (!p_opts.filter.empty()) setenv("SN_TEST_FILTER", p_opts.filter.c_str(), 1);
+  if (!p_opts.output.empty()) setenv("SN_TEST_OUTPUT", p_opts.output.c_str(), 1);
+
   char* args[] = {strdup(output.c_str()), NULL};
   int result = execvp(args[0], args);
 
@@ -4,6 +4,7 @@
 #include "commands/build.h"
 #include "commands/init.h"
 #include "commands/run.h"
+#include "commands/server.h"
 #include "commands/test.h"
 #include "commands/docgen.h"
 #include "constants.h"
@@ -29,9 +30,7 @@ using namespace snowball;
 using namespace std::chrono;
 using namespace snowball::utils;
 
-int _main(int argc, char** argv) {
-  srand((unsigned) time(NULL) * getpid());
-
+int dispatch(int argc, char** argv) {
   try {
     app::CLI* cli = new app::CLI(argc, argv);
     app::Options opts = cli->parse();
@@ -49,6 +48,8 @@ int _main(int argc, char** argv) {
         return app::commands::bench(opts.bench_opts);
       case app::Options::DOCS:
         return app::commands::docgen(opts.docs_opts);
+      case app::Options::SERVER:
+        return app::commands::server(opts.server_opts, dispatch);
       default:
         throw SNError(Error::TODO, FMT("Command with type %i not yet supported", opts.command));
     }
@@ -59,3 +60,20 @@ int _main(int argc, char** argv) {
 
   return EXIT_SUCCESS;
 }
+
+/// @return true if the command can be executed by a running server.
+bool canForward(int argc, char** argv) {
+  if (argc < 2) return false;
+  std::string mode = argv[1];
+  return mode == "build" || mode == "run" || mode == "test" || mode == "bench" || mode == "docs";
+}
+
+int _main(int argc, char** argv) {
+  srand((unsigned) time(NULL) * getpid());
+
+  if (canForward(argc, argv)) {
+    if (auto status = app::server::forward(argc, argv)) return *status;
+  }
+
+  return dispatch(argc, argv);
+}
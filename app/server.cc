@@ -0,0 +1,510 @@
+#include "server.h"
+
+#include "builder/llvm/LLVMBuilder.h"
+#include "constants.h"
+#include "errors.h"
+#include "services/PrecompiledCache.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <filesystem>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+extern char** environ;
+
+// Protocol used between the CLI and the server (over a unix socket):
+//  - Both ends check that the other one runs as the same user (the client
+//    sends its environment and standard streams, the server runs commands).
+//  - Both ends send a hello: the protocol version and the identity of the
+//    compiler binary. A client never forwards a command to a different
+//    compiler, the server only accepts `REQUEST_STOP` from one.
+//  - The client sends a request kind. For `REQUEST_RUN`, its stdin, stdout and
+//    stderr are attached to it (SCM_RIGHTS) and the kind is followed by the
+//    command line, the working directory and the environment.
+//  - The server answers with the exit status (an int32) once the command
+//    finished.
+// Strings are sent as a uint32 length followed by their bytes.
+
+namespace fs = std::filesystem;
+
+namespace snowball {
+namespace app {
+namespace server {
+
+namespace {
+const char REQUEST_RUN = 'R';
+const char REQUEST_STOP = 'S';
+// Bump this every time the protocol changes. Being sent first, its first
+// byte must never be a request kind (servers that predate the hello
+// read it as one and just drop the connection).
+const uint32_t PROTOCOL_VERSION = 2;
+const char* COMPILER_IDENTITY =
+        "snowball " _SNOWBALL_VERSION " (" _SNOWBALL_BUILD_TYPE ": " _SNOWBALL_BUILD_DATE ", " _SNOWBALL_BUILD_TIME ")";
+// Connections are accepted one at a time, so a client that connects and
+// then stays silent (or a stuck one) must not block everyone else.
+const int HANDSHAKE_TIMEOUT_MS = 2000;
+
+bool writeAll(int fd, const void* data, size_t size) {
+  auto bytes = (const char*) data;
+  while (size > 0) {
+    auto written = write(fd, bytes, size);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return false;
+    bytes += written;
+    size -= written;
+  }
+
+  return true;
+}
+
+bool readAll(int fd, void* data, size_t size) {
+  auto bytes = (char*) data;
+  while (size > 0) {
+    auto result = read(fd, bytes, size);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) return false;
+    bytes += result;
+    size -= result;
+  }
+
+  return true;
+}
+
+bool writeString(int fd, const std::string& str) {
+  uint32_t size = str.size();
+  return writeAll(fd, &size, sizeof(size)) && writeAll(fd, str.data(), size);
+}
+
+bool readString(int fd, std::string& str) {
+  uint32_t size;
+  if (!readAll(fd, &size, sizeof(size))) return false;
+  str.resize(size);
+  return readAll(fd, str.data(), size);
+}
+
+bool writeStrings(int fd, const std::vector<std::string>& strings) {
+  uint32_t count = strings.size();
+  if (!writeAll(fd, &count, sizeof(count))) return false;
+  for (auto& str : strings) {
+    if (!writeString(fd, str)) return false;
+  }
+
+  return true;
+}
+
+bool readStrings(int fd, std::vector<std::string>& strings) {
+  uint32_t count;
+  if (!readAll(fd, &count, sizeof(count))) return false;
+  strings.resize(count);
+  for (auto& str : strings) {
+    if (!readString(fd, str)) return false;
+  }
+
+  return true;
+}
+
+/// @brief Send the request kind alongside the given file descriptors.
+bool sendKind(int fd, char kind, const std::vector<int>& fds) {
+  iovec iov = {.iov_base = &kind, .iov_len = 1};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  std::vector<char> control(CMSG_SPACE(sizeof(int) * fds.size()));
+  if (!fds.empty()) {
+    msg.msg_control = control.data();
+    msg.msg_controllen = control.size();
+    auto cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+    memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+  }
+
+  return sendmsg(fd, &msg, 0) == 1;
+}
+
+/// @brief Receive the request kind and the file descriptors attached to it.
+bool receiveKind(int fd, char& kind, std::vector<int>& fds) {
+  iovec iov = {.iov_base = &kind, .iov_len = 1};
+  msghdr msg = {};
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+
+  char control[CMSG_SPACE(sizeof(int) * 3)];
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+  if (recvmsg(fd, &msg, 0) != 1) return false;
+
+  for (auto cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+    auto count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    fds.resize(count);
+    memcpy(fds.data(), CMSG_DATA(cmsg), sizeof(int) * count);
+  }
+
+  return true;
+}
+
+/// @return true if the process at the other end of the socket runs as our user.
+bool isOwnUser(int fd) {
+#ifdef __linux__
+  ucred cred;
+  socklen_t size = sizeof(cred);
+  if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &size) != 0) return false;
+  return cred.uid == geteuid();
+#else
+  uid_t uid;
+  gid_t gid;
+  if (getpeereid(fd, &uid, &gid) != 0) return false;
+  return uid == geteuid();
+#endif
+}
+
+bool writeHello(int fd) {
+  return writeAll(fd, &PROTOCOL_VERSION, sizeof(PROTOCOL_VERSION)) && writeString(fd, COMPILER_IDENTITY);
+}
+
+/// @brief Read the hello of the other end.
+/// @return false if the connection failed, @param compatible tells if it
+///  runs the same compiler as we do.
+bool readHello(int fd, bool& compatible) {
+  uint32_t version;
+  std::string identity;
+  if (!readAll(fd, &version, sizeof(version)) || version != PROTOCOL_VERSION) return false;
+  if (!readString(fd, identity)) return false;
+  compatible = identity == COMPILER_IDENTITY;
+  return true;
+}
+
+/// @return Folder of the socket when there's no runtime folder to use.
+fs::path getDefaultSocketFolder() { return "/tmp/snowball-" + std::to_string(geteuid()); }
+
+/**
+ * @brief Make sure nobody else can reach the folder the socket lives in.
+ *
+ * The default folder (`/tmp/snowball-<uid>`) is created if needed. Since
+ * its path is predictable, it's only used if it's a directory we own that
+ * no one else has access to. Other folders (e.g. `$XDG_RUNTIME_DIR`) are
+ * trusted, the socket itself is only accessible by us (see `serve`) and
+ * connections from other users are rejected anyway.
+ */
+void prepareSocketFolder(const fs::path& path) {
+  auto folder = path.parent_path();
+  if (folder != getDefaultSocketFolder()) return;
+  if (mkdir(folder.c_str(), 0700) != 0 && errno != EEXIST) {
+    throw SNError(Error::IO_ERROR, FMT("Couldn't create %s: %s", folder.c_str(), strerror(errno)));
+  }
+
+  struct stat info;
+  if (lstat(folder.c_str(), &info) != 0 || !S_ISDIR(info.st_mode) || info.st_uid != geteuid() ||
+      (info.st_mode & 077) != 0) {
+    throw SNError(
+            Error::IO_ERROR,
+            FMT("Refusing to use %s for the server socket: it must be a folder only accessible by you", folder.c_str())
+    );
+  }
+}
+
+/// @brief Make reads and writes on @param fd fail after @param ms
+///  milliseconds without progress (0 waits forever again).
+void setTimeout(int fd, int ms) {
+  timeval timeout = {.tv_sec = ms / 1000, .tv_usec = (ms % 1000) * 1000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+/// @brief Create a socket that isn't inherited by the commands we execute.
+int createSocket() {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd >= 0) fcntl(fd, F_SETFD, FD_CLOEXEC);
+  return fd;
+}
+
+enum class Connection
+{
+  /// Connected to a server running the same compiler
+  OK,
+  /// There's no server running
+  NONE,
+  /// The socket belongs to another user
+  FOREIGN,
+  /// The server runs another version of the compiler
+  MISMATCH
+};
+
+/// @return The connection to the server (or -1), @param status tells why
+///  there's no connection. Mismatched servers are still connected to.
+int connectToServer(Connection& status) {
+  status = Connection::NONE;
+  auto path = getSocketPath();
+  sockaddr_un address = {};
+  if (path.size() >= sizeof(address.sun_path)) return -1;
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  int fd = createSocket();
+  if (fd < 0) return -1;
+  if (connect(fd, (sockaddr*) &address, sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  // Nothing is sent before knowing who's listening.
+  if (!isOwnUser(fd)) {
+    status = Connection::FOREIGN;
+    close(fd);
+    return -1;
+  }
+
+  bool compatible = false;
+  if (!writeHello(fd) || !readHello(fd, compatible)) {
+    // Most likely a server that predates the hello
+    status = Connection::MISMATCH;
+    close(fd);
+    return -1;
+  }
+
+  status = compatible ? Connection::OK : Connection::MISMATCH;
+  return fd;
+}
+
+/// @brief Execute a request in a new process, this is the only code that
+///  runs in the forked process before the command itself.
+[[noreturn]] void runRequest(Handler handler, const std::vector<int>& fds, int connection) {
+  std::vector<std::string> args, env;
+  std::string cwd;
+  if (fds.size() != 3 || !readStrings(connection, args) || !readString(connection, cwd) || !readStrings(connection, env) ||
+      args.empty()) {
+    _exit(EXIT_FAILURE);
+  }
+
+  // The request is executed by a child so that we can keep watching the
+  // connection: a client going away (e.g. ctrl+c) kills the command. It
+  // gets its own process group so that whatever it spawned (the linker,
+  // the program being run...) gets killed along with it.
+  auto worker = fork();
+  if (worker < 0) _exit(EXIT_FAILURE);
+  if (worker == 0) {
+    setpgid(0, 0);
+    // Every request would otherwise generate the same "random" names as
+    // the others (e.g. for temporary files), since they all inherit our state.
+    srand((unsigned) time(NULL) * getpid());
+    close(connection);
+    for (int i = 0; i < 3; ++i) dup2(fds[i], i);
+    for (auto fd : fds) close(fd);
+    if (chdir(cwd.c_str()) != 0) _exit(EXIT_FAILURE);
+
+    auto vars = new char*[env.size() + 1];
+    for (size_t i = 0; i < env.size(); ++i) vars[i] = strdup(env[i].c_str());
+    vars[env.size()] = nullptr;
+    environ = vars;
+    std::vector<char*> argv;
+    for (auto& arg : args) argv.push_back(strdup(arg.c_str()));
+    argv.push_back(nullptr);
+    exit(handler(argv.size() - 1, argv.data()));
+  }
+
+  // Also done here, the group must exist before we may have to kill it.
+  setpgid(worker, worker);
+  for (auto fd : fds) close(fd);
+  int32_t result = EXIT_FAILURE;
+  while (true) {
+    int status;
+    auto done = waitpid(worker, &status, WNOHANG);
+    if (done == worker) {
+      result = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+      break;
+    }
+
+    pollfd watch = {.fd = connection, .events = POLLIN};
+    if (poll(&watch, 1, 50) > 0 && (watch.revents & (POLLHUP | POLLERR | POLLIN))) {
+      char byte;
+      if (recv(connection, &byte, 1, MSG_PEEK | MSG_DONTWAIT) <= 0) {
+        kill(-worker, SIGKILL);
+        waitpid(worker, nullptr, 0);
+        _exit(EXIT_FAILURE);
+      }
+    }
+  }
+
+  writeAll(connection, &result, sizeof(result));
+  _exit(EXIT_SUCCESS);
+}
+} // namespace
+
+std::string getSocketPath() {
+  if (auto path = getenv("SNOWBALL_SERVER_SOCKET")) return path;
+  if (auto runtime = getenv("XDG_RUNTIME_DIR")) return (fs::path(runtime) / "snowball.sock").string();
+  return (getDefaultSocketFolder() / "server.sock").string();
+}
+
+int serve(Handler handler, bool silent) {
+  auto path = getSocketPath();
+  Connection status;
+  if (auto fd = connectToServer(status); fd >= 0 || status == Connection::MISMATCH) {
+    if (fd >= 0) close(fd);
+    throw SNError(Error::IO_ERROR, FMT("A snowball server is already running (%s)", path.c_str()));
+  } else if (status == Connection::FOREIGN) {
+    throw SNError(Error::IO_ERROR, FMT("%s is being listened to by another user", path.c_str()));
+  }
+
+  prepareSocketFolder(path);
+
+  sockaddr_un address = {};
+  if (path.size() >= sizeof(address.sun_path)) {
+    throw SNError(Error::IO_ERROR, FMT("Server socket path is too long (%s)", path.c_str()));
+  }
+
+  address.sun_family = AF_UNIX;
+  strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  unlink(path.c_str()); // Left behind by a server that didn't stop cleanly
+
+  // The socket is created with the right permissions, there's no window
+  // where other users could connect to it.
+  int server = createSocket();
+  auto mask = umask(0077);
+  bool listening = server >= 0 && bind(server, (sockaddr*) &address, sizeof(address)) == 0 && listen(server, 64) == 0;
+  umask(mask);
+  if (!listening) throw SNError(Error::IO_ERROR, FMT("Couldn't listen to %s: %s", path.c_str(), strerror(errno)));
+
+  // Everything done here is inherited by the processes executing requests:
+  // the LLVM targets, a target machine for the host and the parsed
+  // standard library.
+  codegen::LLVMBuilder::initializeLLVM();
+  codegen::LLVMBuilder::warmTargetMachine({});
+  try {
+    services::PrecompiledCache::preload(utils::get_lib_folder());
+  } catch (const SNError&) {
+    // Without a standard library there's nothing to preload
+  }
+
+  if (!silent) Logger::message("Listening", FMT("on %s (pid %i)", path.c_str(), (int) getpid()));
+
+  // Request processes are never waited, let the system reap them
+  signal(SIGCHLD, SIG_IGN);
+  while (true) {
+    int connection = accept(server, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+
+    fcntl(connection, F_SETFD, FD_CLOEXEC);
+    setTimeout(connection, HANDSHAKE_TIMEOUT_MS);
+    bool compatible = false;
+    if (!isOwnUser(connection) || !writeHello(connection) || !readHello(connection, compatible)) {
+      close(connection);
+      continue;
+    }
+
+    char kind;
+    std::vector<int> fds;
+    if (!receiveKind(connection, kind, fds)) {
+      close(connection);
+      continue;
+    }
+
+    if (kind == REQUEST_STOP) {
+      int32_t result = EXIT_SUCCESS;
+      writeAll(connection, &result, sizeof(result));
+      close(connection);
+      break;
+    }
+
+    if (kind == REQUEST_RUN && compatible) {
+      auto pid = fork();
+      if (pid == 0) {
+        close(server);
+        signal(SIGCHLD, SIG_DFL);
+        // The rest of the request is read by the child, it can take as long as it needs.
+        setTimeout(connection, 0);
+        runRequest(handler, fds, connection);
+      }
+    }
+
+    for (auto fd : fds) close(fd);
+    close(connection);
+  }
+
+  close(server);
+  unlink(path.c_str());
+  if (!silent) Logger::message("Stopped", "snowball server");
+  return EXIT_SUCCESS;
+}
+
+std::optional<int> forward(int argc, char** argv) {
+  if (getenv("SNOWBALL_NO_SERVER")) return std::nullopt;
+  Connection status;
+  int fd = connectToServer(status);
+  if (status == Connection::FOREIGN) {
+    Logger::warning(FMT("Ignoring the snowball server at %s, it belongs to another user", getSocketPath().c_str()));
+  } else if (status == Connection::MISMATCH) {
+    Logger::warning("The running snowball server is a different version, restart it to use it again");
+  }
+
+  if (status != Connection::OK) {
+    if (fd >= 0) close(fd);
+    return std::nullopt;
+  }
+
+  std::vector<std::string> args(argv, argv + argc);
+  std::vector<std::string> env;
+  for (auto var = environ; *var; ++var) env.push_back(*var);
+  std::error_code ec;
+  auto cwd = fs::current_path(ec);
+
+  // If sending fails nothing got executed yet, we can still compile locally
+  if (ec || !sendKind(fd, REQUEST_RUN, {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO}) || !writeStrings(fd, args) ||
+      !writeString(fd, cwd.string()) || !writeStrings(fd, env)) {
+    close(fd);
+    return std::nullopt;
+  }
+
+  int32_t result;
+  bool received = readAll(fd, &result, sizeof(result));
+  close(fd);
+  if (!received) {
+    Logger::error("Lost the connection with the snowball server");
+    return EXIT_FAILURE;
+  }
+
+  return result;
+}
+
+int stop(bool silent) {
+  Connection status;
+  int fd = connectToServer(status);
+  if (fd < 0) {
+    if (status == Connection::MISMATCH) {
+      Logger::error("The running snowball server is too old to be stopped by this version");
+      return EXIT_FAILURE;
+    }
+
+    if (!silent) Logger::warning("There's no snowball server running");
+    return EXIT_SUCCESS;
+  }
+
+  int32_t result = EXIT_FAILURE;
+  if (sendKind(fd, REQUEST_STOP, {})) readAll(fd, &result, sizeof(result));
+  close(fd);
+  return result;
+}
+
+} // namespace server
+} // namespace app
+} // namespace snowball
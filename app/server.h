@@ -0,0 +1,54 @@
+
+#include <optional>
+#include <string>
+
+#ifndef __SNOWBALL_APP_SERVER_H_
+#define __SNOWBALL_APP_SERVER_H_
+
+namespace snowball {
+namespace app {
+namespace server {
+
+/// @brief Function executing a command line (e.g. `snowball build`).
+using Handler = int (*)(int argc, char** argv);
+
+/**
+ * @return The path of the socket the server listens to. It's
+ *  `$SNOWBALL_SERVER_SOCKET` if set or a per user socket otherwise
+ *  (inside `$XDG_RUNTIME_DIR` or a `/tmp/snowball-<uid>` folder only
+ *  accessible by the user).
+ */
+std::string getSocketPath();
+
+/**
+ * @brief Run the compiler server until it's stopped.
+ *
+ * The server does all of the setup that's shared between compilations
+ * once (initializing LLVM, creating a target machine for the host and
+ * parsing the standard library). Every request is then executed by a
+ * process forked from it, so compilations start warm but never share any
+ * state between them. The forked process uses the working directory,
+ * environment and standard streams of the client.
+ *
+ * Only the user running the server can connect to it, and only clients
+ * running the same compiler binary can execute commands.
+ */
+int serve(Handler handler, bool silent);
+
+/**
+ * @brief Forward a command line to a running server.
+ * @return The exit status of the command or nothing if there's no
+ *  server running (or the command can't be forwarded). Servers owned by
+ *  another user or running another compiler version are never used.
+ * @note It can be disabled by setting `SNOWBALL_NO_SERVER`.
+ */
+std::optional<int> forward(int argc, char** argv);
+
+/// @brief Ask the running server (if any) to stop.
+int stop(bool silent);
+
+} // namespace server
+} // namespace app
+} // namespace snowball
+
+#endif // __SNOWBALL_APP_SERVER_H_
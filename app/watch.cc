@@ -0,0 +1,249 @@
+#include "watch.h"
+
+#include "builder/llvm/LLVMBuilder.h"
+#include "constants.h"
+#include "errors.h"
+#include "services/PrecompiledCache.h"
+#include "utils/logger.h"
+#include "utils/utils.h"
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace snowball {
+namespace app {
+namespace watch {
+
+namespace {
+// Editors usually save a file in more than one step (e.g. write + rename)
+const int DEBOUNCE_MS = 100;
+const int POLL_MS = 200;
+
+fs::path getManifestPath() { return fs::current_path() / _SNOWBALL_CACHE_DIR / "objects.json"; }
+
+using DependencyGraph = std::map<fs::path, std::set<fs::path>>;
+
+/// @return The import graph of the last build (see `ObjectCache`).
+DependencyGraph getDependencyGraph() {
+  DependencyGraph graph;
+  auto cwd = fs::current_path();
+  auto normalize = [&](fs::path path) { return path.is_absolute() ? path : (cwd / path).lexically_normal(); };
+
+  std::ifstream is(getManifestPath());
+  if (!is.is_open()) return graph;
+  auto manifest = nlohmann::json::parse(is, nullptr, false);
+  if (manifest.is_discarded() || !manifest["sources"].is_object()) return graph;
+  for (auto& [source, info] : manifest["sources"].items()) {
+    auto& imports = graph[normalize(source)];
+    if (!info.is_object() || !info["imports"].is_array()) continue;
+    for (auto& dependency : info["imports"]) {
+      if (dependency.is_string()) imports.insert(normalize(dependency.get<std::string>()));
+    }
+  }
+
+  return graph;
+}
+
+/// @return Every file the last build depended on.
+std::set<fs::path> getWatchedFiles(const fs::path& entry, const DependencyGraph& graph) {
+  std::set<fs::path> files = {fs::absolute(entry).lexically_normal(), fs::current_path() / "sn.toml"};
+  for (auto& [source, _] : graph) files.insert(source);
+  return files;
+}
+
+/// @return The files that (transitively) import any of the changed ones,
+///  including the changed files themselves.
+std::set<fs::path> getAffectedFiles(const DependencyGraph& graph, const std::set<fs::path>& changed) {
+  std::map<fs::path, std::set<fs::path>> importers;
+  for (auto& [source, imports] : graph) {
+    for (auto& dependency : imports) importers[dependency].insert(source);
+  }
+
+  std::set<fs::path> affected;
+  std::vector<fs::path> pending(changed.begin(), changed.end());
+  while (!pending.empty()) {
+    auto file = pending.back();
+    pending.pop_back();
+    if (!affected.insert(file).second) continue;
+    for (auto& importer : importers[file]) pending.push_back(importer);
+  }
+
+  return affected;
+}
+
+/// @brief Keep the AST of every source file in memory, so that builds only
+///  parse the files that changed since the previous one.
+void preloadSources(const std::set<fs::path>& files) {
+  for (auto& file : files) {
+    if (file.extension() != ".sn") continue;
+    services::PrecompiledCache::preloadFile(file);
+  }
+}
+
+/**
+ * @brief Reports which of the watched files changed.
+ *
+ * On linux, the folders containing the files are watched with inotify (files
+ * can't be watched directly since editors usually replace them). Anywhere
+ * else, modification times are polled.
+ */
+class Watcher {
+#if defined(__linux__)
+  int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  std::map<int, fs::path> folders;
+#else
+  std::map<fs::path, fs::file_time_type> times;
+#endif
+
+public:
+  /// @brief Start watching the given files (alongside the ones already watched).
+  void add(const std::set<fs::path>& files) {
+    for (auto& file : files) {
+#if defined(__linux__)
+      auto folder = file.parent_path();
+      auto mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE;
+      int wd = inotify_add_watch(fd, folder.c_str(), mask);
+      if (wd >= 0) folders[wd] = folder;
+#else
+      std::error_code ec;
+      if (!times.count(file)) times[file] = fs::last_write_time(file, ec);
+#endif
+    }
+  }
+
+  /// @return The files that changed, waiting at most @param timeout milliseconds.
+  std::set<fs::path> poll(int timeout) {
+    std::set<fs::path> changed;
+#if defined(__linux__)
+    pollfd watch = {.fd = fd, .events = POLLIN};
+    if (::poll(&watch, 1, timeout) <= 0) return changed;
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t size;
+    while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+      for (char* ptr = buffer; ptr < buffer + size;) {
+        auto event = (inotify_event*) ptr;
+        if (event->len > 0 && folders.count(event->wd)) changed.insert(folders[event->wd] / event->name);
+        ptr += sizeof(inotify_event) + event->len;
+      }
+    }
+#else
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+    for (auto& [file, time] : times) {
+      std::error_code ec;
+      auto now = fs::last_write_time(file, ec);
+      if (now == time) continue;
+      time = now;
+      changed.insert(file);
+    }
+#endif
+    return changed;
+  }
+};
+
+void stop(pid_t pid) {
+  kill(pid, SIGTERM);
+  for (int i = 0; i < 20; ++i) {
+    if (waitpid(pid, nullptr, WNOHANG) == pid) return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  }
+
+  kill(pid, SIGKILL);
+  waitpid(pid, nullptr, 0);
+}
+} // namespace
+
+void watch(const std::function<int()>& command, const fs::path& entry, bool silent) {
+  // Done once for every build (see `snowball server`)
+  codegen::LLVMBuilder::initializeLLVM();
+  try {
+    services::PrecompiledCache::preload(utils::get_lib_folder());
+  } catch (const SNError&) { }
+
+  Watcher watcher;
+  auto manifest = getManifestPath();
+  std::error_code ec; // Its folder must exist to be watched
+  fs::create_directories(manifest.parent_path(), ec);
+  while (true) {
+    auto graph = getDependencyGraph();
+    auto files = getWatchedFiles(entry, graph);
+    watcher.add(files);
+    watcher.add({manifest});
+    // Every build gets its own copy of the parsed files through fork().
+    preloadSources(files);
+
+    auto pid = fork();
+    if (pid == 0) {
+      int status = EXIT_FAILURE;
+      try {
+        status = command();
+      } catch (const SNError& error) { error.print_error(); }
+      exit(status);
+    }
+
+    bool running = pid > 0;
+    std::set<fs::path> triggers;
+    auto collect = [&](const std::set<fs::path>& changed) {
+      for (auto& file : changed) {
+        if (files.count(file)) triggers.insert(file);
+      }
+    };
+    while (triggers.empty()) {
+      int status;
+      if (running && waitpid(pid, &status, WNOHANG) == pid) {
+        running = false;
+        graph = getDependencyGraph();
+        files = getWatchedFiles(entry, graph);
+        watcher.add(files);
+        auto code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        if (!silent) Logger::message("Watching", FMT("for changes (exited with status %i)", code));
+      }
+
+      auto changed = watcher.poll(POLL_MS);
+      // A new build finished, it may depend on new files
+      if (changed.count(manifest)) {
+        graph = getDependencyGraph();
+        files = getWatchedFiles(entry, graph);
+        watcher.add(files);
+      }
+      collect(changed);
+    }
+
+    for (auto changed = watcher.poll(DEBOUNCE_MS); !changed.empty(); changed = watcher.poll(DEBOUNCE_MS)) {
+      collect(changed);
+    }
+    if (running) stop(pid);
+    if (!silent) {
+      // Only these get parsed again and, alongside the files importing
+      // them, generated again (see `ObjectCache`).
+      auto affected = getAffectedFiles(graph, triggers);
+      Logger::message(
+              "Rebuilding",
+              FMT("(%s changed, %i of %i files affected)",
+                  fs::relative(*triggers.begin()).string().c_str(),
+                  (int) affected.size(),
+                  (int) std::max(graph.size(), affected.size()))
+      );
+    }
+  }
+}
+
+} // namespace watch
+} // namespace app
+} // namespace snowball
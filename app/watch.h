@@ -0,0 +1,35 @@
+
+#include <filesystem>
+#include <functional>
+
+#ifndef __SNOWBALL_APP_WATCH_H_
+#define __SNOWBALL_APP_WATCH_H_
+
+namespace snowball {
+namespace app {
+namespace watch {
+
+/**
+ * @brief Execute @param command and execute it again every time one of
+ *  the files it depends on changes. It never returns.
+ *
+ * The command runs in its own (forked) process, so it may also replace
+ * itself with the compiled program (e.g. `snowball run`). If it's still
+ * running when a file changes, it gets killed before starting again.
+ *
+ * The watched files are the ones in the import graph of the last build
+ * (see `ObjectCache`), alongside @param entry and the project's
+ * configuration. The parsed AST of those files is kept in memory between
+ * builds and only the files that changed get parsed again. Commands are
+ * expected to cache their objects, so that only the modules that changed
+ * (or import a module that changed) get generated, optimized and emitted
+ * again. Every module is still transformed on every build, since the IR
+ * only lives inside the build's process.
+ */
+[[noreturn]] void watch(const std::function<int()>& command, const std::filesystem::path& entry, bool silent);
+
+} // namespace watch
+} // namespace app
+} // namespace snowball
+
+#endif // __SNOWBALL_APP_WATCH_H_
@@ -0,0 +1,159 @@
+
+#include "runtime.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Region (arena) allocator used by `ptr::Arena` and `ptr::ArenaAllocator`.
+// Allocations are bump allocated from big chunks owned by an arena and they
+// are all released at once when the arena is released.
+//
+// Arena memory is only handed out while an arena is *entered* by the current
+// thread (see `Arena::scope`). `ArenaAllocator` and the closure environments
+// allocated by the compiler take it from the innermost entered arena, and
+// from the garbage collected heap when there's none. Chunks are roots of the
+// collector, so that the objects they point to are kept alive. Entering an
+// arena is scoped to a block on the snowball side, the generated cleanup code
+// leaves it again even if an exception unwinds through it.
+//
+// Every block starts with a small header so that `snowball_arena_realloc`
+// and `snowball_arena_free` know how big the block is and where it came from.
+
+namespace snowball {
+namespace {
+
+constexpr size_t ARENA_ALIGNMENT = 16;
+constexpr size_t ARENA_MIN_CHUNK = 64 * 1024;
+constexpr size_t ARENA_MAX_CHUNK = 4 * 1024 * 1024;
+
+struct arena_chunk {
+  arena_chunk* next;
+  size_t size;
+  size_t used;
+};
+
+struct arena {
+  arena_chunk* chunks = nullptr;
+  size_t next_chunk_size = ARENA_MIN_CHUNK;
+};
+
+// Kept at 16 bytes so that the memory after it stays aligned
+struct alignas(ARENA_ALIGNMENT) block_header {
+  uint64_t size;
+  arena* owner; // nullptr for garbage collected blocks
+};
+
+constexpr size_t CHUNK_HEADER = (sizeof(arena_chunk) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+
+thread_local std::vector<arena*> arena_stack;
+
+size_t align_up(size_t size) { return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1); }
+
+void* arena_alloc(arena* a, size_t size) {
+  size = align_up(size);
+  auto chunk = a->chunks;
+  if (!chunk || chunk->size - chunk->used < size) {
+    // Big allocations get a chunk of their own, growing the chunk size
+    // geometrically keeps the amount of chunks low for big arenas.
+    auto chunk_size = std::max(a->next_chunk_size, size);
+    a->next_chunk_size = std::min(a->next_chunk_size * 2, ARENA_MAX_CHUNK);
+    chunk = (arena_chunk*) malloc(CHUNK_HEADER + chunk_size);
+    if (!chunk) return nullptr;
+    chunk->next = a->chunks;
+    chunk->size = chunk_size;
+    chunk->used = 0;
+    a->chunks = chunk;
+    snowball_gc_add_roots(chunk, CHUNK_HEADER + chunk_size);
+  }
+
+  auto result = (char*) chunk + CHUNK_HEADER + chunk->used;
+  chunk->used += size;
+  return result;
+}
+
+} // namespace
+} // namespace snowball
+
+void* snowball_arena_create() { return new snowball::arena(); }
+
+void snowball_arena_enter(void* handle) {
+  using namespace snowball;
+  arena_stack.push_back((arena*) handle);
+}
+
+void snowball_arena_leave(void* handle) {
+  using namespace snowball;
+  // Scopes are left in reverse order, but we don't rely on it.
+  auto it = std::find(arena_stack.rbegin(), arena_stack.rend(), (arena*) handle);
+  if (it != arena_stack.rend()) arena_stack.erase(std::next(it).base());
+}
+
+void snowball_arena_release(void* handle) {
+  using namespace snowball;
+  auto a = (arena*) handle;
+  if (!a) return;
+  // The arena can't stay current once its memory is gone.
+  arena_stack.erase(std::remove(arena_stack.begin(), arena_stack.end(), a), arena_stack.end());
+
+  auto chunk = a->chunks;
+  while (chunk) {
+    auto next = chunk->next;
+    snowball_gc_remove_roots(chunk);
+    free(chunk);
+    chunk = next;
+  }
+  delete a;
+}
+
+void* snowball_arena_alloc(uint64_t size) {
+  using namespace snowball;
+  block_header* header = nullptr;
+  if (!arena_stack.empty()) {
+    auto a = arena_stack.back();
+    header = (block_header*) arena_alloc(a, sizeof(block_header) + size);
+    if (header) header->owner = a;
+  } else {
+    header = (block_header*) snowball_gc_alloc(sizeof(block_header) + size);
+    if (header) header->owner = nullptr;
+  }
+
+  if (!header) return nullptr;
+  header->size = size;
+  return header + 1;
+}
+
+void* snowball_arena_realloc(void* ptr, uint64_t size) {
+  using namespace snowball;
+  if (!ptr) return snowball_arena_alloc(size);
+  // Blocks keep coming from wherever they were first allocated, so that
+  // growing a container inside of an arena doesn't tie it to that arena.
+  auto header = (block_header*) ptr - 1;
+  if (!header->owner) {
+    header = (block_header*) snowball_gc_realloc(header, sizeof(block_header) + size);
+    if (!header) return nullptr;
+    header->size = size;
+    return header + 1;
+  }
+
+  // Arena blocks can't grow in place, the old block is released together
+  // with its arena.
+  if (size <= header->size) return ptr;
+  auto owner = header->owner;
+  auto result = (block_header*) arena_alloc(owner, sizeof(block_header) + size);
+  if (!result) return nullptr;
+  result->owner = owner;
+  result->size = size;
+  memcpy(result + 1, ptr, header->size);
+  return result + 1;
+}
+
+void snowball_arena_free(void* ptr) {
+  using namespace snowball;
+  if (!ptr) return;
+  auto header = (block_header*) ptr - 1;
+  // Arena blocks are released together with their arena
+  if (!header->owner) snowball_gc_free(header);
+}
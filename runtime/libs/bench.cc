@@ -0,0 +1,386 @@
+
+#include "runtime.h"
+#include "harness.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+// Benchmark harness used by `snowball bench`. Every benchmark is warmed up,
+// then its iteration count is calibrated so that a single sample takes long
+// enough to be measured accurately and, finally, a fixed amount of samples
+// is taken. All the times are measured on a monotonic nanosecond clock.
+//
+// The harness is configured through the following environment variables
+// (set by the `bench` command):
+//  - SN_BENCH_SAMPLES: number of samples taken per benchmark.
+//  - SN_BENCH_WARMUP_MS: time spent warming up each benchmark.
+//  - SN_BENCH_SAMPLE_MS: minimum time a single sample should take.
+//  - SN_BENCH_OUTPUT: file where the JSON results are written.
+//  - SN_BENCH_BASELINE: JSON results of a previous run to compare against.
+//  - SN_BENCH_THRESHOLD: change (in %) considered a regression.
+
+namespace snowball {
+namespace {
+
+typedef int32_t (*benchmark_fn)();
+
+struct bench_config {
+  int samples = 20;
+  double warmup_ns = 100e6;
+  double sample_ns = 10e6;
+  double threshold = 5.0;
+  const char* output = nullptr;
+  const char* baseline = nullptr;
+};
+
+struct bench_result {
+  std::string name;
+  uint64_t iterations;
+  std::vector<double> samples; // nanoseconds per iteration
+  double min, max, mean, median, p95, stddev;
+};
+
+// Volatile so that the compiler can't get rid of the benchmark's result
+volatile int32_t bench_sink;
+
+uint64_t run_iterations(benchmark_fn fn, uint64_t iterations) {
+  auto start = now_ns();
+  for (uint64_t i = 0; i < iterations; ++i) bench_sink = fn();
+  return now_ns() - start;
+}
+
+// Linear interpolation between closest ranks, `sorted` must not be empty
+double percentile(const std::vector<double>& sorted, double p) {
+  auto rank = p * (sorted.size() - 1);
+  auto lower = (size_t) rank;
+  auto upper = std::min(lower + 1, sorted.size() - 1);
+  return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+}
+
+bench_result run_benchmark(benchmark_fn fn, const char* name, const bench_config& config) {
+  bench_result result;
+  result.name = name;
+
+  // Warmup, also gives a first estimation of how long an iteration takes
+  uint64_t warmup_iterations = 0, warmup_time = 0;
+  do {
+    warmup_time += run_iterations(fn, 1);
+    warmup_iterations++;
+  } while (warmup_time < config.warmup_ns);
+
+  // Calibrate the iteration count, starting from the warmup estimation
+  auto per_iteration = std::max(1.0, (double) warmup_time / warmup_iterations);
+  uint64_t iterations = std::max(1.0, std::ceil(config.sample_ns / per_iteration));
+  while (run_iterations(fn, iterations) < config.sample_ns / 2 && iterations < (1ull << 40)) iterations *= 2;
+  result.iterations = iterations;
+
+  for (int i = 0; i < config.samples; ++i)
+    result.samples.push_back((double) run_iterations(fn, iterations) / iterations);
+
+  auto sorted = result.samples;
+  std::sort(sorted.begin(), sorted.end());
+  result.min = sorted.front();
+  result.max = sorted.back();
+  result.median = percentile(sorted, 0.5);
+  result.p95 = percentile(sorted, 0.95);
+
+  double sum = 0;
+  for (auto s : sorted) sum += s;
+  result.mean = sum / sorted.size();
+  double variance = 0;
+  for (auto s : sorted) variance += (s - result.mean) * (s - result.mean);
+  result.stddev = sorted.size() > 1 ? std::sqrt(variance / (sorted.size() - 1)) : 0;
+  return result;
+}
+
+std::string format_time(double ns) {
+  char buffer[32];
+  if (ns < 1e3) snprintf(buffer, sizeof(buffer), "%.2fns", ns);
+  else if (ns < 1e6) snprintf(buffer, sizeof(buffer), "%.2fus", ns / 1e3);
+  else if (ns < 1e9) snprintf(buffer, sizeof(buffer), "%.2fms", ns / 1e6);
+  else snprintf(buffer, sizeof(buffer), "%.2fs", ns / 1e9);
+  return buffer;
+}
+
+void write_results(const char* path, const std::vector<bench_result>& results) {
+  std::ofstream os(path, std::ios::trunc);
+  if (!os.is_open()) {
+    fprintf(stderr, "\e[1;33mwarning\e[0m: could not write benchmark results to '%s'\n", path);
+    return;
+  }
+
+  os << "{\n  \"version\": 1,\n  \"benchmarks\": [\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto& r = results[i];
+    char line[512];
+    snprintf(line, sizeof(line),
+             "\"iterations\": %llu, \"samples\": %zu, \"min_ns\": %.3f, \"max_ns\": %.3f, \"mean_ns\": %.3f, "
+             "\"median_ns\": %.3f, \"p95_ns\": %.3f, \"stddev_ns\": %.3f",
+             (unsigned long long) r.iterations, r.samples.size(), r.min, r.max, r.mean, r.median, r.p95, r.stddev);
+    os << "    {\"name\": \"" << escape_json(r.name) << "\", " << line << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n}\n";
+}
+
+// A JSON value, only what's needed to read a baseline back.
+struct json_value {
+  enum { null, boolean, number, string, array, object } kind = null;
+  double num = 0;
+  std::string str;
+  std::vector<json_value> items;
+  std::vector<std::pair<std::string, json_value>> members;
+
+  const json_value* get(const std::string& key) const {
+    for (auto& [name, value] : members)
+      if (name == key) return &value;
+    return nullptr;
+  }
+};
+
+// Recursive descent parser for (strict) JSON. `parse` returns false on any
+// syntax error.
+class json_parser {
+  const std::string& src;
+  size_t pos = 0;
+
+public:
+  json_parser(const std::string& src) : src(src) {}
+
+  bool parse(json_value& result) {
+    if (!parse_value(result, 0)) return false;
+    skip_whitespace();
+    return pos == src.size();
+  }
+
+private:
+  // Deep enough for any baseline, it just keeps corrupted files from
+  // overflowing the stack.
+  static constexpr int max_depth = 64;
+
+  void skip_whitespace() {
+    while (pos < src.size() && (src[pos] == ' ' || src[pos] == '\t' || src[pos] == '\n' || src[pos] == '\r')) ++pos;
+  }
+
+  bool consume(char c) {
+    skip_whitespace();
+    if (pos >= src.size() || src[pos] != c) return false;
+    ++pos;
+    return true;
+  }
+
+  bool consume_word(const char* word) {
+    auto size = strlen(word);
+    if (src.compare(pos, size, word) != 0) return false;
+    pos += size;
+    return true;
+  }
+
+  bool parse_value(json_value& result, int depth) {
+    if (depth > max_depth) return false;
+    skip_whitespace();
+    if (pos >= src.size()) return false;
+    switch (src[pos]) {
+      case '{': return parse_object(result, depth);
+      case '[': return parse_array(result, depth);
+      case '"': result.kind = json_value::string; return parse_string(result.str);
+      case 't': result.kind = json_value::boolean; result.num = 1; return consume_word("true");
+      case 'f': result.kind = json_value::boolean; return consume_word("false");
+      case 'n': return consume_word("null");
+      default: return parse_number(result);
+    }
+  }
+
+  bool parse_object(json_value& result, int depth) {
+    result.kind = json_value::object;
+    ++pos;
+    if (consume('}')) return true;
+    do {
+      std::string key;
+      skip_whitespace();
+      if (pos >= src.size() || src[pos] != '"' || !parse_string(key) || !consume(':')) return false;
+      result.members.emplace_back(std::move(key), json_value());
+      if (!parse_value(result.members.back().second, depth + 1)) return false;
+    } while (consume(','));
+    return consume('}');
+  }
+
+  bool parse_array(json_value& result, int depth) {
+    result.kind = json_value::array;
+    ++pos;
+    if (consume(']')) return true;
+    do {
+      result.items.emplace_back();
+      if (!parse_value(result.items.back(), depth + 1)) return false;
+    } while (consume(','));
+    return consume(']');
+  }
+
+  bool parse_number(json_value& result) {
+    // strtod accepts more than JSON does (hex, inf, nan...), so the
+    // characters are checked first.
+    auto start = pos;
+    if (pos < src.size() && src[pos] == '-') ++pos;
+    if (pos >= src.size() || !isdigit((unsigned char) src[pos])) return false;
+    while (pos < src.size() && (isdigit((unsigned char) src[pos]) || strchr(".eE+-", src[pos]))) ++pos;
+    auto text = src.substr(start, pos - start);
+    char* end;
+    result.kind = json_value::number;
+    result.num = strtod(text.c_str(), &end);
+    return *end == '\0';
+  }
+
+  bool parse_hex(uint32_t& result) {
+    if (pos + 4 > src.size()) return false;
+    result = 0;
+    for (int i = 0; i < 4; ++i) {
+      auto c = src[pos++];
+      if (!isxdigit((unsigned char) c)) return false;
+      result = result * 16 + (isdigit((unsigned char) c) ? c - '0' : (tolower(c) - 'a' + 10));
+    }
+    return true;
+  }
+
+  void append_utf8(std::string& result, uint32_t code) {
+    if (code < 0x80) {
+      result += (char) code;
+    } else if (code < 0x800) {
+      result += (char) (0xC0 | (code >> 6));
+      result += (char) (0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      result += (char) (0xE0 | (code >> 12));
+      result += (char) (0x80 | ((code >> 6) & 0x3F));
+      result += (char) (0x80 | (code & 0x3F));
+    } else {
+      result += (char) (0xF0 | (code >> 18));
+      result += (char) (0x80 | ((code >> 12) & 0x3F));
+      result += (char) (0x80 | ((code >> 6) & 0x3F));
+      result += (char) (0x80 | (code & 0x3F));
+    }
+  }
+
+  bool parse_string(std::string& result) {
+    ++pos; // opening quote
+    while (pos < src.size()) {
+      auto c = src[pos++];
+      if (c == '"') return true;
+      if ((unsigned char) c < 0x20) return false;
+      if (c != '\\') {
+        result += c;
+        continue;
+      }
+      if (pos >= src.size()) return false;
+      switch (src[pos++]) {
+        case '"': result += '"'; break;
+        case '\\': result += '\\'; break;
+        case '/': result += '/'; break;
+        case 'b': result += '\b'; break;
+        case 'f': result += '\f'; break;
+        case 'n': result += '\n'; break;
+        case 'r': result += '\r'; break;
+        case 't': result += '\t'; break;
+        case 'u': {
+          uint32_t code;
+          if (!parse_hex(code)) return false;
+          // Surrogate pairs encode characters outside of the BMP
+          if (code >= 0xD800 && code < 0xDC00) {
+            uint32_t low;
+            if (!consume_word("\\u") || !parse_hex(low) || low < 0xDC00 || low >= 0xE000) return false;
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+          }
+          append_utf8(result, code);
+          break;
+        }
+        default: return false;
+      }
+    }
+    return false;
+  }
+};
+
+std::map<std::string, double> read_baseline(const char* path) {
+  std::map<std::string, double> medians;
+  std::ifstream is(path);
+  if (!is.is_open()) {
+    fprintf(stderr, "\e[1;33mwarning\e[0m: could not read benchmark baseline '%s'\n", path);
+    return medians;
+  }
+
+  std::string source((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  json_value root;
+  if (!json_parser(source).parse(root) || root.kind != json_value::object) {
+    fprintf(stderr, "\e[1;33mwarning\e[0m: benchmark baseline '%s' is not valid JSON\n", path);
+    return medians;
+  }
+
+  auto benchmarks = root.get("benchmarks");
+  if (!benchmarks || benchmarks->kind != json_value::array) return medians;
+  for (auto& benchmark : benchmarks->items) {
+    auto name = benchmark.get("name");
+    auto median = benchmark.get("median_ns");
+    if (!name || name->kind != json_value::string || !median || median->kind != json_value::number) continue;
+    medians[name->str] = median->num;
+  }
+  return medians;
+}
+
+} // namespace
+} // namespace snowball
+
+int32_t snowball_bench_run(void** functions, const char** names, int32_t size) {
+  using namespace snowball;
+  bench_config config;
+  config.samples = (int) env_number("SN_BENCH_SAMPLES", config.samples, false);
+  config.warmup_ns = env_number("SN_BENCH_WARMUP_MS", config.warmup_ns / 1e6, false) * 1e6;
+  config.sample_ns = env_number("SN_BENCH_SAMPLE_MS", config.sample_ns / 1e6, false) * 1e6;
+  config.threshold = env_number("SN_BENCH_THRESHOLD", config.threshold, false);
+  config.output = getenv("SN_BENCH_OUTPUT");
+  config.baseline = getenv("SN_BENCH_BASELINE");
+
+  std::map<std::string, double> baseline;
+  if (config.baseline && *config.baseline) baseline = read_baseline(config.baseline);
+
+  std::vector<bench_result> results;
+  int32_t regressions = 0;
+  printf("\n \e[1m%-32s %12s %12s %12s %12s %10s\e[0m\n", "benchmark", "median", "p95", "stddev", "iterations", "change");
+  for (int32_t i = 0; i < size; ++i) {
+    auto result = run_benchmark((benchmark_fn) functions[i], names[i], config);
+
+    std::string change = "-";
+    const char* color = "\e[0m";
+    if (auto base = baseline.find(result.name); base != baseline.end() && base->second > 0) {
+      auto percent = (result.median - base->second) / base->second * 100;
+      char buffer[32];
+      snprintf(buffer, sizeof(buffer), "%+.2f%%", percent);
+      change = buffer;
+      if (percent > config.threshold) {
+        color = "\e[1;31m";
+        regressions++;
+      } else if (percent < -config.threshold) {
+        color = "\e[1;32m";
+      }
+    }
+
+    printf(" \e[1m%-32s\e[0m %12s %12s %12s %12llu %s%10s\e[0m\n", result.name.c_str(), format_time(result.median).c_str(),
+           format_time(result.p95).c_str(), format_time(result.stddev).c_str(), (unsigned long long) result.iterations,
+           color, change.c_str());
+    fflush(stdout);
+    results.push_back(std::move(result));
+  }
+
+  if (config.output && *config.output) write_results(config.output, results);
+  if (regressions > 0)
+    printf("\n \e[1;31m%i benchmark(s) regressed\e[0m more than %.2f%% compared to '%s'\n", regressions, config.threshold,
+           config.baseline);
+  printf("\n");
+  return regressions;
+}
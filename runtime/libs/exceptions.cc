@@ -54,6 +54,8 @@ extern "C" {
 struct OurExceptionType_t {
   /// type info type
   int type;
+  /// name of the thrown class
+  const char* name;
 };
 
 /**
@@ -96,6 +98,7 @@ typedef struct _Unwind_Exception OurUnwindException;
 namespace snowball {
 
 int64_t ourBaseFromUnwindOffset;
+unhandled_exception_handler unhandledExceptionHandler = nullptr;
 
 const unsigned char ourBaseExcpClassChars[] =
     {'o', 'b', 'j', '\0', 's', 'n', '\0'};
@@ -615,9 +618,13 @@ void end_stack(void* exep) {
   void *obj = base->snowball_object;
   auto *hdr = (SnowballExceptionInstance_t *)obj;
 
-  // TODO: Class name and location
+  if (unhandledExceptionHandler)
+    unhandledExceptionHandler(base->type.name, hdr->length > 0 ? hdr->message : "", hdr->length > 0 ? hdr->length : 0);
+
+  // TODO: location
   std::ostringstream buf;
   error_log(buf, "fatal unhandled exception");
+  buf << " (" << base->type.name << ")";
   if (hdr->length > 0) {
     //hdr->message[hdr->length] = '\0';
     buf << ": \033[0m";
@@ -639,7 +646,7 @@ void end_stack(void* exep) {
 // MARK: - Eported functions
 
 void throwOurException(void* obj) __asm__("sn.eh.throw");
-void *createOurException(void* obj, int type) __asm__("sn.eh.create");
+void *createOurException(void* obj, int type, const char* name) __asm__("sn.eh.create");
 _Unwind_Reason_Code ourPersonality(int version,
                                    _Unwind_Action actions,
                                    uint64_t exceptionClass,
@@ -649,10 +656,11 @@ _Unwind_Reason_Code ourPersonality(int version,
 /// Creates (allocates on the heap), an exception (OurException instance),
 /// of the supplied type info type.
 /// @param type type info type
-void *createOurException(void* obj, int type) {
+void *createOurException(void* obj, int type, const char* name) {
   const size_t size = sizeof(OurException);
   OurException *ret = (OurException*) memset(malloc(size), 0, size);
   ret->type.type = type;
+  ret->type.name = name;
   ret->snowball_object = obj;
   ret->unwindException.exception_class = snowball::ourBaseExceptionClass;
   ret->unwindException.exception_cleanup = snowball::deleteFromUnwindOurException;
@@ -734,6 +742,10 @@ void throwOurException(void *exc) {
 }
 
 namespace snowball {
+void set_unhandled_exception_handler(unhandled_exception_handler handler) {
+  unhandledExceptionHandler = handler;
+}
+
 void initialize_exceptions() {
   ourBaseFromUnwindOffset = exception_offset();
   ourBaseExceptionClass = exception_class();
@@ -7,6 +7,11 @@
 namespace snowball {
 uint64_t exception_class();
 int64_t exception_offset();
+
+/// @brief Called with the class name and the message of an exception that
+///  nobody caught, right before the program aborts.
+typedef void (*unhandled_exception_handler)(const char* type, const char* message, int length);
+void set_unhandled_exception_handler(unhandled_exception_handler handler);
 };
 
 #endif // _SNOWBALL_RUNTIME_EXCEPTIONS_H_
@@ -0,0 +1,556 @@
+#include "runtime.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csetjmp>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unordered_set>
+#include <vector>
+
+#if !defined(__APPLE__)
+#include <link.h>
+#endif
+
+// Conservative, non-moving mark & sweep collector behind `sn.gc.alloc`.
+//
+// It backs the heap memory of snowball programs: escaping closures, string
+// buffers and the buffers of `ptr::Allocator` (and thus of vectors). Small
+// objects are taken from pages dedicated to a single size class, each class
+// keeping a free list of its released cells. Big objects get an allocation of
+// their own. Owners that know when their memory dies (e.g. destructors) give
+// it back right away with `sn.gc.free`, the collector reclaims the rest.
+//
+// There is a single heap shared by every thread. A thread is registered the
+// first time it allocates, and a collection stops every other registered
+// thread (by sending it a signal) while it marks.
+//
+// Roots are found conservatively: the registers and the stacks of every
+// registered thread, the writable segments of every loaded object and the
+// ranges registered with `sn.gc.add_roots` (e.g. arena chunks or the data
+// sections emitted by the JIT) are scanned for words that point into (or
+// inside of) a live object. Reachable objects are scanned the same way. This
+// means the code generator doesn't need to emit stack maps nor safepoints;
+// collections only happen inside of an allocation.
+//
+// note: Memory taken directly from malloc isn't scanned, objects only
+//  referenced from there (or from threads that never allocated) can be
+//  collected.
+
+namespace snowball {
+namespace {
+
+constexpr size_t GC_PAGE_SIZE = 64 * 1024;
+constexpr size_t GC_GRANULE = 16;
+constexpr size_t GC_MIN_THRESHOLD = 4 * 1024 * 1024;
+constexpr size_t GC_SIZE_CLASSES[] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024, 1536, 2048};
+constexpr size_t GC_NUM_SIZE_CLASSES = sizeof(GC_SIZE_CLASSES) / sizeof(GC_SIZE_CLASSES[0]);
+
+#if defined(SIGPWR)
+constexpr int GC_SUSPEND_SIGNAL = SIGPWR;
+#else
+constexpr int GC_SUSPEND_SIGNAL = SIGXFSZ;
+#endif
+constexpr int GC_RESUME_SIGNAL = SIGXCPU;
+
+struct free_cell {
+  free_cell* next;
+};
+
+struct alignas(GC_GRANULE) gc_page {
+  size_t size_class;
+  size_t cell_size;
+  size_t cells;
+  size_t live;
+  // One byte per cell, simpler (and faster) than packing bits
+  uint8_t* allocated;
+  uint8_t* marked;
+
+  char* begin() { return (char*) this + sizeof(gc_page); }
+};
+
+struct alignas(GC_GRANULE) gc_large {
+  size_t size;
+  bool marked;
+};
+
+struct gc_heap {
+  std::unordered_set<gc_page*> pages;
+  std::map<uintptr_t, gc_large*> large;
+  free_cell* free_lists[GC_NUM_SIZE_CLASSES] = {};
+  std::vector<uintptr_t> mark_stack;
+
+  size_t heap_size = 0;
+  size_t allocated_since = 0;
+  size_t threshold = GC_MIN_THRESHOLD;
+  snowball_gc_stats stats = {};
+
+  ~gc_heap() {
+    for (auto page : pages) free_page(page);
+    for (auto [_, object] : large) free(object);
+  }
+
+  static void free_page(gc_page* page) {
+    free(page->allocated);
+    free(page->marked);
+    free(page);
+  }
+};
+
+/// A thread whose registers and stack are scanned by collections
+struct gc_thread {
+  pthread_t id;
+  const void* stack_base;
+  // Only set while the thread is stopped by a collection
+  const void* stack_top = nullptr;
+  jmp_buf registers;
+};
+
+/// Extra root ranges (start -> end)
+std::map<uintptr_t, uintptr_t> roots;
+
+gc_heap heap;
+std::vector<gc_thread*> threads;
+// Guards the heap, the registered threads and the extra roots
+std::mutex heap_mutex;
+
+sem_t stop_acknowledged;
+std::atomic<bool> world_stopped = false;
+
+size_t size_class_of(size_t size) {
+  for (size_t i = 0; i < GC_NUM_SIZE_CLASSES; ++i) {
+    if (size <= GC_SIZE_CLASSES[i]) return i;
+  }
+
+  return GC_NUM_SIZE_CLASSES;
+}
+
+gc_page* page_of(uintptr_t address) {
+  auto page = (gc_page*) (address & ~(GC_PAGE_SIZE - 1));
+  if (!heap.pages.count(page)) return nullptr;
+  return page;
+}
+
+bool new_page(size_t size_class) {
+  auto page = (gc_page*) aligned_alloc(GC_PAGE_SIZE, GC_PAGE_SIZE);
+  if (!page) return false;
+  page->size_class = size_class;
+  page->cell_size = GC_SIZE_CLASSES[size_class];
+  page->cells = (GC_PAGE_SIZE - sizeof(gc_page)) / page->cell_size;
+  page->live = 0;
+  page->allocated = (uint8_t*) calloc(page->cells, 1);
+  page->marked = (uint8_t*) calloc(page->cells, 1);
+  if (!page->allocated || !page->marked) {
+    gc_heap::free_page(page);
+    return false;
+  }
+
+  // Cells are linked backwards so that they are handed out in address order
+  auto& list = heap.free_lists[size_class];
+  for (size_t i = page->cells; i > 0; --i) {
+    auto cell = (free_cell*) (page->begin() + (i - 1) * page->cell_size);
+    cell->next = list;
+    list = cell;
+  }
+
+  heap.pages.insert(page);
+  heap.heap_size += GC_PAGE_SIZE;
+  return true;
+}
+
+/// @return the start of the object containing the address (if any)
+uintptr_t find_object(uintptr_t address) {
+  if (auto page = page_of(address)) {
+    auto begin = (uintptr_t) page->begin();
+    if (address < begin) return 0;
+    auto index = (address - begin) / page->cell_size;
+    if (index >= page->cells || !page->allocated[index]) return 0;
+    return begin + index * page->cell_size;
+  }
+
+  auto it = heap.large.upper_bound(address);
+  if (it == heap.large.begin()) return 0;
+  --it;
+  auto object = it->second;
+  auto begin = (uintptr_t) (object + 1);
+  if (address < begin || address >= begin + object->size) return 0;
+  return begin;
+}
+
+/// @return the amount of usable bytes of an object
+size_t object_size(uintptr_t object) {
+  if (auto page = page_of(object)) return page->cell_size;
+  return ((gc_large*) object - 1)->size;
+}
+
+void mark_address(uintptr_t address) {
+  auto object = find_object(address);
+  if (!object) return;
+  if (auto page = page_of(object)) {
+    auto index = (object - (uintptr_t) page->begin()) / page->cell_size;
+    if (page->marked[index]) return;
+    page->marked[index] = 1;
+  } else {
+    auto large = (gc_large*) object - 1;
+    if (large->marked) return;
+    large->marked = true;
+  }
+
+  heap.mark_stack.push_back(object);
+}
+
+// Scanning conservatively reads whole stack frames, which sanitizers don't like
+__attribute__((no_sanitize_address)) void scan_range(const void* start, const void* end) {
+  auto from = ((uintptr_t) start + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1);
+  for (auto word = (const uintptr_t*) from; word + 1 <= (const uintptr_t*) end; ++word) mark_address(*word);
+}
+
+void scan_object(uintptr_t object) { scan_range((const void*) object, (const void*) (object + object_size(object))); }
+
+const void* stack_base() {
+  static thread_local const void* base = nullptr;
+  if (base) return base;
+#if defined(__APPLE__)
+  base = pthread_get_stackaddr_np(pthread_self());
+#else
+  pthread_attr_t attr;
+  void* address = nullptr;
+  size_t size = 0;
+  if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+    pthread_attr_getstack(&attr, &address, &size);
+    pthread_attr_destroy(&attr);
+  }
+  base = (char*) address + size;
+#endif
+  return base;
+}
+
+gc_thread* find_thread(pthread_t id) {
+  for (auto thread : threads) {
+    if (pthread_equal(thread->id, id)) return thread;
+  }
+
+  return nullptr;
+}
+
+// Only async-signal-safe functions can be used in here
+void suspend_handler(int) {
+  auto saved_errno = errno;
+  // The list of threads can't change while a collection is running
+  auto self = find_thread(pthread_self());
+  if (self) {
+    setjmp(self->registers);
+    self->stack_top = __builtin_frame_address(0);
+  }
+  sem_post(&stop_acknowledged);
+
+  // The resume signal is blocked while we are in here (see `sa_mask`), so it
+  // can't get lost between checking the flag and waiting for it.
+  sigset_t mask;
+  sigfillset(&mask);
+  sigdelset(&mask, GC_RESUME_SIGNAL);
+  while (world_stopped.load()) sigsuspend(&mask);
+  errno = saved_errno;
+}
+
+void resume_handler(int) { }
+
+void install_signal_handlers() {
+  sem_init(&stop_acknowledged, 0, 0);
+  struct sigaction action = {};
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  action.sa_handler = resume_handler;
+  sigaction(GC_RESUME_SIGNAL, &action, nullptr);
+
+  sigaddset(&action.sa_mask, GC_RESUME_SIGNAL);
+  action.sa_handler = suspend_handler;
+  sigaction(GC_SUSPEND_SIGNAL, &action, nullptr);
+}
+
+/// Keeps the current thread registered for as long as it lives
+struct thread_registration {
+  gc_thread* thread = nullptr;
+
+  // Called with the heap locked
+  void ensure() {
+    if (thread) return;
+    static std::once_flag handlers;
+    std::call_once(handlers, install_signal_handlers);
+    thread = new gc_thread {pthread_self(), stack_base()};
+    threads.push_back(thread);
+  }
+
+  ~thread_registration() {
+    if (!thread) return;
+    std::lock_guard<std::mutex> lock(heap_mutex);
+    threads.erase(std::remove(threads.begin(), threads.end(), thread), threads.end());
+    delete thread;
+  }
+};
+
+thread_local thread_registration registration;
+
+void stop_the_world() {
+  world_stopped = true;
+  size_t stopped = 0;
+  for (auto thread : threads) {
+    if (thread == registration.thread) continue;
+    if (pthread_kill(thread->id, GC_SUSPEND_SIGNAL) == 0) stopped++;
+  }
+
+  for (size_t i = 0; i < stopped; ++i) {
+    while (sem_wait(&stop_acknowledged) != 0 && errno == EINTR) { }
+  }
+}
+
+void start_the_world() {
+  world_stopped = false;
+  for (auto thread : threads) {
+    if (thread == registration.thread) continue;
+    thread->stack_top = nullptr;
+    pthread_kill(thread->id, GC_RESUME_SIGNAL);
+  }
+}
+
+#if !defined(__APPLE__)
+int scan_segments(dl_phdr_info* info, size_t, void*) {
+  // Globals can live in any loaded object (e.g. the program being a shared
+  // library or the runtime being loaded into the compiler for the JIT)
+  for (int i = 0; i < info->dlpi_phnum; ++i) {
+    auto& header = info->dlpi_phdr[i];
+    if (header.p_type != PT_LOAD || !(header.p_flags & PF_W)) continue;
+    auto start = (const char*) (info->dlpi_addr + header.p_vaddr);
+    scan_range(start, start + header.p_memsz);
+  }
+
+  return 0;
+}
+#endif
+
+__attribute__((noinline)) void mark_roots() {
+  // Spill the registers into the stack so they get scanned with it
+  jmp_buf registers;
+  setjmp(registers);
+  scan_range(&registers, (const char*) &registers + sizeof(registers));
+  scan_range(__builtin_frame_address(0), stack_base());
+  for (auto thread : threads) {
+    if (thread == registration.thread || !thread->stack_top) continue;
+    scan_range(&thread->registers, (const char*) &thread->registers + sizeof(thread->registers));
+    scan_range(thread->stack_top, thread->stack_base);
+  }
+#if !defined(__APPLE__)
+  dl_iterate_phdr(scan_segments, nullptr);
+#endif
+  for (auto [start, end] : roots) scan_range((const void*) start, (const void*) end);
+}
+
+void sweep() {
+  size_t live = 0;
+  for (auto& list : heap.free_lists) list = nullptr;
+  for (auto it = heap.pages.begin(); it != heap.pages.end();) {
+    auto page = *it;
+    page->live = 0;
+    for (size_t i = 0; i < page->cells; ++i) {
+      if (page->allocated[i] && page->marked[i]) {
+        page->marked[i] = 0;
+        page->live++;
+        continue;
+      }
+
+      if (page->allocated[i]) heap.stats.freed_bytes += page->cell_size;
+      page->allocated[i] = 0;
+    }
+
+    // Empty pages are given back, the rest get their free cells relinked
+    if (page->live == 0) {
+      it = heap.pages.erase(it);
+      heap.heap_size -= GC_PAGE_SIZE;
+      gc_heap::free_page(page);
+      continue;
+    }
+
+    auto& list = heap.free_lists[page->size_class];
+    for (size_t i = page->cells; i > 0; --i) {
+      if (page->allocated[i - 1]) continue;
+      auto cell = (free_cell*) (page->begin() + (i - 1) * page->cell_size);
+      cell->next = list;
+      list = cell;
+    }
+
+    live += page->live * page->cell_size;
+    ++it;
+  }
+
+  for (auto it = heap.large.begin(); it != heap.large.end();) {
+    auto object = it->second;
+    if (object->marked) {
+      object->marked = false;
+      live += object->size;
+      ++it;
+      continue;
+    }
+
+    heap.stats.freed_bytes += object->size;
+    heap.heap_size -= sizeof(gc_large) + object->size;
+    it = heap.large.erase(it);
+    free(object);
+  }
+
+  heap.stats.live_bytes = live;
+}
+
+// Called with the heap locked
+void collect() {
+  auto start = std::chrono::steady_clock::now();
+  registration.ensure();
+  stop_the_world();
+  mark_roots();
+  while (!heap.mark_stack.empty()) {
+    auto object = heap.mark_stack.back();
+    heap.mark_stack.pop_back();
+    scan_object(object);
+  }
+  start_the_world();
+
+  sweep();
+  heap.allocated_since = 0;
+  heap.threshold = std::max(GC_MIN_THRESHOLD, heap.stats.live_bytes * 2);
+  heap.stats.collections++;
+  heap.stats.pause_ns +=
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void* allocate_small(size_t size_class) {
+  auto& list = heap.free_lists[size_class];
+  if (!list && !new_page(size_class)) return nullptr;
+  auto cell = list;
+  list = cell->next;
+
+  auto page = page_of((uintptr_t) cell);
+  auto index = ((char*) cell - page->begin()) / page->cell_size;
+  page->allocated[index] = 1;
+  page->live++;
+  memset(cell, 0, page->cell_size);
+  return cell;
+}
+
+void* allocate_large(size_t size) {
+  size = (size + GC_GRANULE - 1) & ~(GC_GRANULE - 1);
+  auto object = (gc_large*) aligned_alloc(GC_GRANULE, sizeof(gc_large) + size);
+  if (!object) return nullptr;
+  object->size = size;
+  object->marked = false;
+  memset(object + 1, 0, size);
+  heap.large[(uintptr_t) (object + 1)] = object;
+  heap.heap_size += sizeof(gc_large) + size;
+  return object + 1;
+}
+
+// Called with the heap locked
+void* allocate(size_t size) {
+  registration.ensure();
+  if (size == 0) size = 1;
+  if (heap.allocated_since >= heap.threshold) collect();
+
+  auto size_class = size_class_of(size);
+  void* result = size_class < GC_NUM_SIZE_CLASSES ? allocate_small(size_class) : allocate_large(size);
+  if (!result) {
+    // Try again after freeing as much as we can
+    collect();
+    result = size_class < GC_NUM_SIZE_CLASSES ? allocate_small(size_class) : allocate_large(size);
+    if (!result) return nullptr;
+  }
+
+  auto allocated = object_size((uintptr_t) result);
+  heap.allocated_since += allocated;
+  heap.stats.allocated_bytes += allocated;
+  heap.stats.heap_bytes = heap.heap_size;
+  return result;
+}
+
+// Called with the heap locked
+void release(uintptr_t object) {
+  if (auto page = page_of(object)) {
+    auto index = (object - (uintptr_t) page->begin()) / page->cell_size;
+    page->allocated[index] = 0;
+    page->live--;
+    heap.stats.freed_bytes += page->cell_size;
+    auto cell = (free_cell*) object;
+    cell->next = heap.free_lists[page->size_class];
+    heap.free_lists[page->size_class] = cell;
+    return;
+  }
+
+  auto large = (gc_large*) object - 1;
+  heap.stats.freed_bytes += large->size;
+  heap.heap_size -= sizeof(gc_large) + large->size;
+  heap.large.erase(object);
+  free(large);
+}
+
+} // namespace
+} // namespace snowball
+
+void snowball_gc_collect() {
+  using namespace snowball;
+  std::lock_guard<std::mutex> lock(heap_mutex);
+  collect();
+}
+
+void* snowball_gc_alloc(uint64_t size) {
+  using namespace snowball;
+  std::lock_guard<std::mutex> lock(heap_mutex);
+  return allocate(size);
+}
+
+void* snowball_gc_realloc(void* ptr, uint64_t size) {
+  using namespace snowball;
+  std::lock_guard<std::mutex> lock(heap_mutex);
+  if (!ptr) return allocate(size);
+  auto object = find_object((uintptr_t) ptr);
+  if (object != (uintptr_t) ptr) return nullptr;
+
+  auto old_size = object_size(object);
+  if (size <= old_size) return ptr;
+  auto result = allocate(size);
+  if (!result) return nullptr;
+  memcpy(result, ptr, old_size);
+  release(object);
+  return result;
+}
+
+void snowball_gc_free(void* ptr) {
+  using namespace snowball;
+  std::lock_guard<std::mutex> lock(heap_mutex);
+  // Only the start of a live object can be freed
+  auto object = find_object((uintptr_t) ptr);
+  if (object && object == (uintptr_t) ptr) release(object);
+}
+
+void snowball_gc_add_roots(const void* start, uint64_t size) {
+  using namespace snowball;
+  std::lock_guard<std::mutex> lock(heap_mutex);
+  roots[(uintptr_t) start] = (uintptr_t) start + size;
+}
+
+void snowball_gc_remove_roots(const void* start) {
+  using namespace snowball;
+  std::lock_guard<std::mutex> lock(heap_mutex);
+  roots.erase((uintptr_t) start);
+}
+
+void snowball_gc_stats_get(snowball_gc_stats* stats) {
+  using namespace snowball;
+  std::lock_guard<std::mutex> lock(heap_mutex);
+  heap.stats.heap_bytes = heap.heap_size;
+  *stats = heap.stats;
+}
@@ -0,0 +1,56 @@
+#include "harness.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <time.h>
+
+namespace snowball {
+
+uint64_t now_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+double env_number(const char* name, double fallback, bool allow_zero) {
+  auto value = getenv(name);
+  if (!value || !*value) return fallback;
+  char* end;
+  auto result = strtod(value, &end);
+  return (*end || result < 0 || (result == 0 && !allow_zero)) ? fallback : result;
+}
+
+std::string escape_json(const std::string& str) {
+  std::string result;
+  for (auto c : str) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    } else if (c == '\n') {
+      result += "\\n";
+      continue;
+    } else if ((unsigned char) c < 0x20) {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char) c);
+      result += escaped;
+      continue;
+    }
+    result += c;
+  }
+  return result;
+}
+
+std::string escape_xml(const std::string& str) {
+  std::string result;
+  for (auto c : str) {
+    switch (c) {
+      case '<': result += "&lt;"; break;
+      case '>': result += "&gt;"; break;
+      case '&': result += "&amp;"; break;
+      case '"': result += "&quot;"; break;
+      default: result += c;
+    }
+  }
+  return result;
+}
+
+} // namespace snowball
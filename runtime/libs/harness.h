@@ -0,0 +1,23 @@
+#include <cstdint>
+#include <string>
+
+#ifndef _SNOWBALL_RUNTIME_HARNESS_H_
+#define _SNOWBALL_RUNTIME_HARNESS_H_
+
+// Helpers shared by the test runner (test.cc) and the benchmark harness (bench.cc).
+namespace snowball {
+
+/// @return Current time of a monotonic clock, in nanoseconds.
+uint64_t now_ns();
+/// @return The number stored in the environment variable @param name or
+///  @param fallback if it's unset, not a number, negative or, unless
+///  @param allow_zero is set, zero.
+double env_number(const char* name, double fallback, bool allow_zero);
+/// @return @param str escaped to be used inside a JSON string.
+std::string escape_json(const std::string& str);
+/// @return @param str escaped to be used inside an XML attribute or element.
+std::string escape_xml(const std::string& str);
+
+} // namespace snowball
+
+#endif // _SNOWBALL_RUNTIME_HARNESS_H_
@@ -18,7 +18,34 @@ void initialize_segfault_handler();
 void error_log(std::ostringstream& oss, const char *message);
 }
 
+/// @brief Statistics of the garbage collected heap
+struct snowball_gc_stats {
+  uint64_t collections;
+  uint64_t allocated_bytes;
+  uint64_t freed_bytes;
+  uint64_t live_bytes;
+  uint64_t heap_bytes;
+  uint64_t pause_ns;
+};
+
 void initialize_snowball(int flags) __asm__("sn.runtime.initialize");
 int snowball_errno() _SN_SYM("sn.runtime.errno");
+int32_t snowball_bench_run(void** functions, const char** names, int32_t size) _SN_SYM("sn.runtime.bench.run");
+int32_t snowball_test_run(void** functions, const char** names, const int32_t* expects, const int8_t* skips, int32_t size)
+        _SN_SYM("sn.runtime.test.run");
+void* snowball_arena_create() _SN_SYM("sn.runtime.arena.create");
+void snowball_arena_enter(void* arena) _SN_SYM("sn.runtime.arena.enter");
+void snowball_arena_leave(void* arena) _SN_SYM("sn.runtime.arena.leave");
+void snowball_arena_release(void* arena) _SN_SYM("sn.runtime.arena.release");
+void* snowball_arena_alloc(uint64_t size) _SN_SYM("sn.runtime.arena.alloc");
+void* snowball_arena_realloc(void* ptr, uint64_t size) _SN_SYM("sn.runtime.arena.realloc");
+void snowball_arena_free(void* ptr) _SN_SYM("sn.runtime.arena.free");
+void* snowball_gc_alloc(uint64_t size) _SN_SYM("sn.gc.alloc");
+void* snowball_gc_realloc(void* ptr, uint64_t size) _SN_SYM("sn.gc.realloc");
+void snowball_gc_free(void* ptr) _SN_SYM("sn.gc.free");
+void snowball_gc_collect() _SN_SYM("sn.gc.collect");
+void snowball_gc_stats_get(snowball_gc_stats* stats) _SN_SYM("sn.gc.stats");
+void snowball_gc_add_roots(const void* start, uint64_t size) _SN_SYM("sn.gc.add_roots");
+void snowball_gc_remove_roots(const void* start) _SN_SYM("sn.gc.remove_roots");
 
 #endif // _SNOWBALL_RUNTIME_H_
@@ -0,0 +1,355 @@
+
+#include "runtime.h"
+#include "exceptions.h"
+#include "harness.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <exception>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+// Test runner used by `snowball test`. Every test is executed in its own
+// forked process so that a crash (or a test that never finishes) only
+// affects that test, and up to `SN_TEST_JOBS` tests run at the same time.
+// The output of each test is captured and only shown if the test fails.
+//
+// The runner is configured through the following environment variables
+// (set by the `test` command):
+//  - SN_TEST_JOBS: number of tests executed at the same time (default: one per core).
+//  - SN_TEST_TIMEOUT: seconds a test can run before it's killed (0 = no timeout).
+//  - SN_TEST_FILTER: only run the tests whose name contains this string.
+//  - SN_TEST_OUTPUT: file where the results are written. JUnit XML is used if
+//    the file ends with ".xml", JSON otherwise.
+
+namespace snowball {
+namespace {
+
+typedef int32_t (*test_fn)();
+
+struct test_config {
+  long jobs = 1;
+  double timeout_ns = 0;
+  const char* filter = nullptr;
+  const char* output = nullptr;
+};
+
+enum class test_status { PASSED, FAILED, SKIPPED, CRASHED, TIMEOUT };
+
+struct test_result {
+  std::string name;
+  test_status status = test_status::SKIPPED;
+  int32_t expected = 1;
+  int32_t actual = 0;
+  double duration_ns = 0;
+  std::string message;
+  std::string output;
+};
+
+// Written by the test process and read by the runner once it exits.
+struct shared_result {
+  int32_t value;
+  int32_t finished;
+  // Set if the test died because of an exception nobody caught.
+  char exception[256];
+};
+
+struct running_test {
+  size_t index;
+  pid_t pid;
+  int output_fd;
+  uint64_t start;
+};
+
+std::string read_output(int fd) {
+  std::string output;
+  char buffer[4096];
+  lseek(fd, 0, SEEK_SET);
+  ssize_t size;
+  while ((size = read(fd, buffer, sizeof(buffer))) > 0) output.append(buffer, size);
+  close(fd);
+  return output;
+}
+
+// Result slot of the test running in this (child) process.
+shared_result* current_result = nullptr;
+
+void record_exception(const char* type, const char* message, int length) {
+  if (!current_result) return;
+  snprintf(current_result->exception, sizeof(current_result->exception), "uncaught exception '%s': %.*s", type, length,
+           message);
+}
+
+// Exceptions thrown by C++ code (e.g. the runtime itself) end up here instead.
+[[noreturn]] void on_terminate() {
+  std::string type = "unknown", what;
+  if (auto exception = std::current_exception()) {
+    if (auto info = abi::__cxa_current_exception_type()) {
+      int status = 0;
+      auto demangled = abi::__cxa_demangle(info->name(), nullptr, nullptr, &status);
+      type = status == 0 ? demangled : info->name();
+      free(demangled);
+    }
+    try {
+      std::rethrow_exception(exception);
+    } catch (const std::exception& e) {
+      what = e.what();
+    } catch (...) {}
+  }
+  record_exception(type.c_str(), what.c_str(), (int) what.size());
+  fprintf(stderr, "terminate called after throwing an instance of '%s'\n  what(): %s\n", type.c_str(), what.c_str());
+  fflush(stdout);
+  fflush(stderr);
+  abort();
+}
+
+bool start_test(running_test& test, test_fn fn, shared_result* shared) {
+  char path[] = "/tmp/sn-test-XXXXXX";
+  test.output_fd = mkstemp(path);
+  if (test.output_fd < 0) return false;
+  unlink(path);
+
+  fflush(stdout);
+  fflush(stderr);
+  test.start = now_ns();
+  test.pid = fork();
+  if (test.pid < 0) {
+    close(test.output_fd);
+    return false;
+  }
+
+  if (test.pid == 0) {
+    dup2(test.output_fd, STDOUT_FILENO);
+    dup2(test.output_fd, STDERR_FILENO);
+    current_result = shared;
+    set_unhandled_exception_handler(record_exception);
+    std::set_terminate(on_terminate);
+    shared->value = fn();
+    shared->finished = 1;
+    fflush(stdout);
+    fflush(stderr);
+    _exit(0);
+  }
+
+  return true;
+}
+
+void finish_test(running_test& test, int status, test_result& result, const shared_result& shared) {
+  result.duration_ns = now_ns() - test.start;
+  result.output = read_output(test.output_fd);
+  if (result.status == test_status::TIMEOUT) return;
+
+  if (shared.finished) {
+    result.actual = shared.value;
+    result.status = shared.value == result.expected ? test_status::PASSED : test_status::FAILED;
+    if (result.status == test_status::FAILED)
+      result.message = "expected " + std::to_string(result.expected) + " but got " + std::to_string(shared.value);
+  } else {
+    result.status = test_status::CRASHED;
+    if (shared.exception[0])
+      result.message = std::string(shared.exception, strnlen(shared.exception, sizeof(shared.exception)));
+    else if (WIFSIGNALED(status)) result.message = std::string("killed by signal: ") + strsignal(WTERMSIG(status));
+    else result.message = "exited with code " + std::to_string(WEXITSTATUS(status));
+  }
+}
+
+const char* status_name(test_status status) {
+  switch (status) {
+    case test_status::PASSED: return "passed";
+    case test_status::FAILED: return "failed";
+    case test_status::SKIPPED: return "skipped";
+    case test_status::CRASHED: return "crashed";
+    case test_status::TIMEOUT: return "timeout";
+  }
+  return "unknown";
+}
+
+void print_result(const test_result& result, size_t index, size_t total) {
+  auto width = std::to_string(total).size();
+  printf(" Testing \e[1m%-44s\e[0m [(%0*zu\e[0;30m/%zu\e[0m)]\t... ", result.name.c_str(), (int) width, index, total);
+  switch (result.status) {
+    case test_status::PASSED: printf("\e[1;32mnice!\e[0m \e[0;30m(%.2fms)\e[0m\n", result.duration_ns / 1e6); break;
+    case test_status::SKIPPED: printf("\e[1;33mwip\e[0m\n"); break;
+    default: {
+      printf("\e[1;31m%s\e[0m\n", status_name(result.status));
+      printf("\n ------- %s failure -------\n\n  %s\n", result.name.c_str(), result.message.c_str());
+      if (!result.output.empty()) printf("\n%s", result.output.c_str());
+      printf("\n");
+    }
+  }
+  fflush(stdout);
+}
+
+void write_results(const char* path, const std::vector<test_result>& results) {
+  std::ofstream os(path, std::ios::trunc);
+  if (!os.is_open()) {
+    fprintf(stderr, "\e[1;33mwarning\e[0m: could not write test results to '%s'\n", path);
+    return;
+  }
+
+  auto length = strlen(path);
+  if (length > 4 && strcmp(path + length - 4, ".xml") == 0) {
+    size_t failures = 0, skipped = 0;
+    double total = 0;
+    for (auto& r : results) {
+      failures += r.status != test_status::PASSED && r.status != test_status::SKIPPED;
+      skipped += r.status == test_status::SKIPPED;
+      total += r.duration_ns;
+    }
+    os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    os << "<testsuite name=\"snowball\" tests=\"" << results.size() << "\" failures=\"" << failures << "\" skipped=\""
+       << skipped << "\" time=\"" << total / 1e9 << "\">\n";
+    for (auto& r : results) {
+      os << "  <testcase name=\"" << escape_xml(r.name) << "\" time=\"" << r.duration_ns / 1e9 << "\"";
+      if (r.status == test_status::PASSED) {
+        os << "/>\n";
+        continue;
+      }
+      os << ">\n";
+      if (r.status == test_status::SKIPPED) os << "    <skipped/>\n";
+      else
+        os << "    <failure type=\"" << status_name(r.status) << "\" message=\"" << escape_xml(r.message) << "\">"
+           << escape_xml(r.output) << "</failure>\n";
+      os << "  </testcase>\n";
+    }
+    os << "</testsuite>\n";
+    return;
+  }
+
+  os << "{\n  \"version\": 1,\n  \"tests\": [\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    auto& r = results[i];
+    os << "    {\"name\": \"" << escape_json(r.name) << "\", \"status\": \"" << status_name(r.status)
+       << "\", \"duration_ms\": " << r.duration_ns / 1e6 << ", \"expected\": " << r.expected << ", \"actual\": " << r.actual
+       << ", \"message\": \"" << escape_json(r.message) << "\", \"output\": \"" << escape_json(r.output) << "\"}"
+       << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  os << "  ]\n}\n";
+}
+
+} // namespace
+} // namespace snowball
+
+int32_t snowball_test_run(void** functions, const char** names, const int32_t* expects, const int8_t* skips, int32_t size) {
+  using namespace snowball;
+  test_config config;
+  config.jobs = (long) env_number("SN_TEST_JOBS", 0, true);
+  if (config.jobs <= 0) config.jobs = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+  config.timeout_ns = env_number("SN_TEST_TIMEOUT", 0, true) * 1e9;
+  config.filter = getenv("SN_TEST_FILTER");
+  config.output = getenv("SN_TEST_OUTPUT");
+
+  std::vector<test_result> results;
+  std::vector<size_t> selected;
+  for (int32_t i = 0; i < size; ++i) {
+    if (config.filter && *config.filter && !strstr(names[i], config.filter)) continue;
+    test_result result;
+    result.name = names[i];
+    result.expected = expects[i];
+    results.push_back(result);
+    selected.push_back(i);
+  }
+
+  printf("\nExecuting \e[1;34m%zu\e[0m test(s)", results.size());
+  if (selected.size() != (size_t) size) printf(" (%zu filtered out)", size - selected.size());
+  printf(" with %li job(s)...\n\n", config.jobs);
+
+  if (results.empty()) {
+    printf("\e[1;33m"
+           "  Oops! It seems like our tests have gone on vacation!\n\n"
+           "  They must be off sunbathing on a tropical beach or enjoying some\n"
+           "  well-deserved rest.\n\n"
+           "  While they're out having fun, why don't you \n"
+           "  take this opportunity to show off your code's confidence by giving\n"
+           "  it a high-five?\n\n"
+           "  Remember, real programmers write self-assured code that\n"
+           "  doesn't need tests to prove its awesomeness! 😉\e[0m\n\n");
+    return 0;
+  }
+
+  auto shared = (shared_result*) mmap(nullptr, sizeof(shared_result) * results.size(), PROT_READ | PROT_WRITE,
+                                      MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    fprintf(stderr, "\e[1;31merror\e[0m: could not allocate memory for the test results (%s)\n", strerror(errno));
+    return 1;
+  }
+  memset(shared, 0, sizeof(shared_result) * results.size());
+
+  size_t next = 0, reported = 0;
+  std::vector<running_test> running;
+  while (next < results.size() || !running.empty()) {
+    while (next < results.size() && (long) running.size() < config.jobs) {
+      auto index = next++;
+      if (skips[selected[index]]) {
+        print_result(results[index], ++reported, results.size());
+        continue;
+      }
+      running_test test;
+      test.index = index;
+      if (!start_test(test, (test_fn) functions[selected[index]], &shared[index])) {
+        results[index].status = test_status::CRASHED;
+        results[index].message = std::string("could not start the test: ") + strerror(errno);
+        print_result(results[index], ++reported, results.size());
+        continue;
+      }
+      running.push_back(test);
+    }
+
+    bool progress = false;
+    for (auto it = running.begin(); it != running.end();) {
+      int status = 0;
+      auto& result = results[it->index];
+      auto pid = waitpid(it->pid, &status, WNOHANG);
+      if (pid == 0 && config.timeout_ns > 0 && now_ns() - it->start > config.timeout_ns) {
+        kill(it->pid, SIGKILL);
+        pid = waitpid(it->pid, &status, 0);
+        result.status = test_status::TIMEOUT;
+        result.message = "timed out after " + std::to_string((int) (config.timeout_ns / 1e9)) + "s";
+      }
+      if (pid == 0) {
+        ++it;
+        continue;
+      }
+
+      finish_test(*it, status, result, shared[it->index]);
+      print_result(result, ++reported, results.size());
+      it = running.erase(it);
+      progress = true;
+    }
+
+    if (!progress && !running.empty()) {
+      timespec delay = {0, 1000000}; // 1ms
+      nanosleep(&delay, nullptr);
+    }
+  }
+  munmap(shared, sizeof(shared_result) * results.size());
+
+  size_t passed = 0, failed = 0, skipped = 0;
+  for (auto& r : results) {
+    if (r.status == test_status::PASSED) passed++;
+    else if (r.status == test_status::SKIPPED) skipped++;
+    else failed++;
+  }
+
+  printf("\nTest results:\n");
+  printf("  \e[1;32m+ %zu\e[0m test(s) passed; ", passed);
+  printf("\n  \e[1;31m- %zu\e[0m test(s) failed; ", failed);
+  printf("\n  \e[1;33m? %zu\e[0m test(s) skipped; ", skipped);
+  printf("\n  \e[1m= %zu\e[0m executed test(s) total\n", passed + failed);
+  printf("  \e[1m=> %zu%%\e[0m of the tests passed. 🧪\n\n", passed + failed ? passed * 100 / (passed + failed) : 0);
+
+  if (config.output && *config.output) write_results(config.output, results);
+  return (int32_t) failed;
+}
@@ -42,6 +42,19 @@ std::optional<std::shared_ptr<transform::Item>> Functions::getTransformedFunctio
   return std::nullopt;
 }
 
+void Functions::setTransformedDeclaration(
+        Statement::FunctionDef* node, types::Type* parent, std::shared_ptr<ir::Func> fn
+) {
+  transformedDeclarations[{node, parent}] = fn;
+}
+
+std::shared_ptr<ir::Func> Functions::getTransformedDeclaration(Statement::FunctionDef* node, types::Type* parent) {
+  auto f = transformedDeclarations.find({node, parent});
+  if (f != transformedDeclarations.end()) return f->second;
+
+  return nullptr;
+}
+
 namespace {
 template <typename T>
 std::map<std::string, T> getAllFunctionsByUUID(std::string uuid, std::map<std::string, T>& functions) {
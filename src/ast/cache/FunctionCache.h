@@ -52,6 +52,9 @@ protected:
   /// @brief A map of states used for generated functions.
   /// @note this can be used for things such as; default arguments
   std::unordered_map<id_t, std::shared_ptr<transform::ContextState>> functionStates;
+  /// @brief The function every non-generic declaration got transformed into,
+  ///  for each class it was declared in (e.g. every instance of a generic class).
+  std::map<std::pair<Statement::FunctionDef*, types::Type*>, std::shared_ptr<ir::Func>> transformedDeclarations;
 
 public:
   /// @brief Set a new function overload
@@ -70,6 +73,10 @@ public:
   void setTransformedFunction(const std::string& uuid, std::shared_ptr<transform::Item> p_fn);
   /// @return get an item of an already transformed function
   std::optional<std::shared_ptr<transform::Item>> getTransformedFunction(const std::string uuid);
+  /// @brief Remember the function a non-generic declaration of @param parent got transformed into
+  void setTransformedDeclaration(Statement::FunctionDef* node, types::Type* parent, std::shared_ptr<ir::Func> fn);
+  /// @return The function a non-generic declaration of @param parent got transformed into (if any)
+  std::shared_ptr<ir::Func> getTransformedDeclaration(Statement::FunctionDef* node, types::Type* parent);
   /// Copy a list of functions to a new list for a new type
   void performInheritance(types::DefinedType* ty, types::DefinedType* parent, bool allowConstructor = false);
 };
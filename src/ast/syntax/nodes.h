@@ -519,11 +519,19 @@ struct FunctionDef : public AcceptorExtend<FunctionDef, Base>,
   // Declaration of wether or not the function is declared
   // as mutable.
   bool _mutable = false;
+  /// @brief Position of the function between all the functions
+  ///  declared in its source file (see `ir::Func::getMangle`).
+  unsigned int declarationIndex = 0;
 
   /// @brief Context state for the function (it shoudn't be used often)
   std::shared_ptr<snowball::Syntax::transform::ContextState> _contextState = nullptr;
 
 public:
+  /// @brief Declaration indexes from this one onwards are reserved for
+  ///  functions generated by the compiler, which aren't declared in any
+  ///  source file and would otherwise share the index of the first one.
+  static constexpr unsigned int GENERATED_DECLARATION_INDEX = 1u << 31;
+
   FunctionDef(const std::string name, Privacy::Status prvc = PRIVATE);
 
   /// @brief Get function's identifier
@@ -567,6 +575,11 @@ public:
   /// @brief Declare a function mutable or not.
   void isMutable(bool m);
 
+  /// @return the position of the function inside its source file
+  auto getDeclarationIndex() const { return declarationIndex; }
+  /// @brief Set the position of the function inside its source file
+  void setDeclarationIndex(unsigned int i) { declarationIndex = i; }
+
   /// Check if the function is declared as an extern function
   virtual bool isExtern() { return false; }
   /// Check if the function is declared as a constructor
@@ -7,6 +7,7 @@
 #include "../syntax/nodes.h"
 #include "Type.h"
 
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -18,6 +19,16 @@ namespace types {
 BaseType::BaseType(Kind t, std::string name) : Type(t, name) { }
 std::shared_ptr<ir::Module> BaseType::getModule() const { return module; }
 std::string BaseType::getUUID() const { return uuid; }
+std::string BaseType::getMangleDisambiguator() const {
+  // The last component of the UUID is the index of the generic instance, which
+  // depends on the transformation order. Generics are mangled on their own anyway.
+  auto base = uuid;
+  auto pos = uuid.find_last_of(':');
+  if (pos != std::string::npos && pos + 1 < uuid.size() &&
+      std::all_of(uuid.begin() + pos + 1, uuid.end(), [](char c) { return std::isdigit(c); }))
+    base = uuid.substr(0, pos);
+  return utils::hashToString(utils::hashString(base));
+}
 void BaseType::unsafeSetUUID(std::string uuid) { this->uuid = uuid; }
 void BaseType::unsafeSetModule(std::shared_ptr<ir::Module> m) { module = m; }
 void BaseType::setDefaultGenerics(std::vector<Type*> generics) { defaultGenerics = generics; }
@@ -50,6 +50,9 @@ public:
   std::shared_ptr<ir::Module> getModule() const;
   /// @brief Get the UUID of the type.
   std::string getUUID() const;
+  /// @brief Get a disambiguator for the mangled name that stays the
+  ///  same between builds (unlike the type id).
+  std::string getMangleDisambiguator() const;
 
   /// @brief Set the module where the type is defined.
   void unsafeSetModule(std::shared_ptr<ir::Module> m);
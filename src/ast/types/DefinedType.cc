@@ -44,18 +44,13 @@ DefinedType::ClassField::ClassField(
 Syntax::Statement::DefinedTypeDef* DefinedType::getAST() const { return ast; }
 void DefinedType::addField(ClassField* f) { fields.emplace_back(f); }
 bool DefinedType::is(DefinedType* ty) const {
-  auto otherArgs = ty->getGenerics();
-  bool genericSizeEqual = otherArgs.size() == generics.size();
-  bool argumentsEqual = genericSizeEqual ? std::all_of(
-                                                   otherArgs.begin(),
-                                                   otherArgs.end(),
-                                                   [&, idx = 0](Type* i) mutable {
-                                                     idx++;
-                                                     return generics.at(idx - 1)->is(i);
-                                                   }
-                                           ) :
-                                           false;
-  return (ty->getUUID() == uuid) && argumentsEqual;
+  if (ty == this) return true;
+  // Generics are only compared for the same type, and without copying them.
+  if (ty->uuid != uuid || ty->generics.size() != generics.size()) return false;
+  for (std::size_t i = 0; i < generics.size(); ++i) {
+    if (!generics[i]->is(ty->generics[i])) return false;
+  }
+  return true;
 }
 
 std::string DefinedType::getPrettyName() const {
@@ -87,10 +82,9 @@ std::string DefinedType::getPrettyName() const {
 
 std::string DefinedType::getMangledName() const {
   auto base = module->getUniqueName();
-  auto _tyID = static_cast<ir::id_t>(getId());
   std::stringstream sstm;
   sstm << (utils::startsWith(base, _SN_MANGLE_PREFIX) ? base : _SN_MANGLE_PREFIX) << "&" << name.size() << name << "Cv"
-       << _tyID;
+       << getMangleDisambiguator();
   auto prefix = sstm.str(); // disambiguator
 
   std::string mangledArgs; // Start args tag
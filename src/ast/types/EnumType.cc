@@ -32,18 +32,13 @@ EnumType::EnumField::EnumField(
       std::vector<types::Type*> types)
     : types(types), name(name) { }
 bool EnumType::is(EnumType* ty) const {
-  auto otherArgs = ty->getGenerics();
-  bool genericSizeEqual = otherArgs.size() == generics.size();
-  bool argumentsEqual = genericSizeEqual ? std::all_of(
-                                                   otherArgs.begin(),
-                                                   otherArgs.end(),
-                                                   [&, idx = 0](Type* i) mutable {
-                                                     idx++;
-                                                     return generics.at(idx - 1)->is(i);
-                                                   }
-                                           ) :
-                                           false;
-  return (ty->getUUID() == uuid) && argumentsEqual;
+  if (ty == this) return true;
+  // Generics are only compared for the same type, and without copying them.
+  if (ty->uuid != uuid || ty->generics.size() != generics.size()) return false;
+  for (std::size_t i = 0; i < generics.size(); ++i) {
+    if (!generics[i]->is(ty->generics[i])) return false;
+  }
+  return true;
 }
 void EnumType::addField(EnumField field) { fields.push_back(field); }
 std::string EnumType::getPrettyName() const {
@@ -66,10 +61,9 @@ std::string EnumType::getPrettyName() const {
 
 std::string EnumType::getMangledName() const {
   auto base = module->getUniqueName();
-  auto _tyID = static_cast<ir::id_t>(getId());
   std::stringstream sstm;
   sstm << (utils::startsWith(base, _SN_MANGLE_PREFIX) ? base : _SN_MANGLE_PREFIX) << "&" << name.size() << name << "Ev"
-       << _tyID;
+       << getMangleDisambiguator();
   auto prefix = sstm.str(); // disambiguator
 
   std::string mangledArgs; // Start args tag
@@ -30,16 +30,13 @@ std::string FunctionType::getPrettyName() const {
 }
 
 bool FunctionType::is(FunctionType* other) const {
-  auto otherArgs = other->getArgs();
-  if (args.size() != otherArgs.size()) return false;
-  bool argumentsEqual =
-          args.size() == 0 ? true : std::all_of(otherArgs.begin(), otherArgs.end(), [&, idx = 0](Type* i) mutable {
-            idx++;
-            return args.at(idx - 1)->is(i);
-          });
+  if (other == this) return true;
+  if (args.size() != other->args.size() || variadic != other->variadic) return false;
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    if (!args[i]->is(other->args[i])) return false;
+  }
 
-  auto returnEquals = retTy->is(other->getRetType());
-  return returnEquals && argumentsEqual && (variadic == other->isVariadic());
+  return retTy->is(other->retTy);
 }
 
 std::string FunctionType::getMangledName() const {
@@ -80,6 +80,11 @@ public:
   std::int32_t getBits() const { return bits; }
   SNOWBALL_TYPE_COPIABLE(FloatType)
 
+  virtual bool is(Type* other) const override {
+    if (auto f = utils::cast<FloatType>(other)) return bits == f->bits;
+    return PrimitiveType::is(other);
+  }
+
   virtual std::int64_t sizeOf() const override { return bits; }
   virtual std::int64_t alignmentOf() const override { return bits; }
 };
@@ -99,6 +104,13 @@ public:
   bool isSigned() const { return isItSigned; }
   SNOWBALL_TYPE_COPIABLE(IntType)
 
+  /// @brief Integers are compared by their width and signedness
+  ///  instead of by their names.
+  virtual bool is(Type* other) const override {
+    if (auto i = utils::cast<IntType>(other)) return bits == i->bits && isItSigned == i->isItSigned;
+    return PrimitiveType::is(other);
+  }
+
   virtual std::int64_t sizeOf() const override { return bits == 1 ? 1 : (std::int64_t)(bits); }
   virtual std::int64_t alignmentOf() const override { return bits == 1 ? 1 : (std::int64_t)(bits); }
 };
@@ -69,9 +69,11 @@ public:
 
   /// @param other another type
   /// @return true if this type is equal to the argument type
-  virtual bool is(Type* other) const { return getName() == other->getName(); }
+  /// @note Types aren't unique objects, so equality is structural. Types
+  ///  without a cheaper comparison of their own fall back to their names.
+  virtual bool is(Type* other) const { return this == other || getName() == other->getName(); }
   /// @return current's type name
-  virtual std::string getName() const { return name; }
+  virtual const std::string& getName() const { return name; }
   /// @return type's pretty names, commonly used for output
   virtual std::string getPrettyName() const { return (_mutable ? "mut " : "") + name; };
   /// @return Get a mangled version of the current type
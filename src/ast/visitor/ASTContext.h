@@ -5,10 +5,10 @@
 
 #include <functional>
 #include <list>
-#include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #ifndef __SNOWBALL_AST_CONTEXT_H_
@@ -23,7 +23,7 @@ namespace Syntax {
 template <typename T>
 class ASTContext {
   using Item = std::shared_ptr<T>;
-  using Scope = std::map<std::string, Item>;
+  using Scope = std::unordered_map<std::string, Item>;
 
 protected:
   /** A scope is a representation of a "block" where all
@@ -42,8 +42,20 @@ protected:
    * This would be equal to the following stack:
    *   if-stmt scope > fn scope > global scope
    *      (no vars)     (var a)   (types, etc)
+   *
+   * Scopes are shared (copy-on-write) with the states saved
+   * from the context. Saving or restoring a state only copies
+   * pointers, a scope is only copied the first time it's
+   * modified while being shared.
    */
-  std::list<Scope> stack = {};
+  std::list<std::shared_ptr<Scope>> stack = {};
+
+  /// @return The current scope, copied first if it's shared with a saved state.
+  Scope& getWritableScope() {
+    auto& scope = stack.front();
+    if (scope.use_count() > 1) scope = std::make_shared<Scope>(*scope);
+    return *scope;
+  }
 
 public:
   ASTContext() {
@@ -61,14 +73,11 @@ public:
    */
   virtual void addItem(const std::string& name, Item item) {
     DEBUG_SYMTABLE(1, FMT("    Adding to scope: %s", name.c_str()).c_str())
-    auto f = stack.front();
-    auto val = f.find(name);
-
-    if (val != f.end()) {
+    if (stack.front()->count(name)) {
       E<VARIABLE_ERROR>(item, FMT("Value for '%s' is already defiend!", item->toString().c_str()));
     }
 
-    stack.front().insert(std::make_pair(name, item));
+    getWritableScope().emplace(name, item);
   }
 
   /**
@@ -77,9 +86,9 @@ public:
    * @param name  Item to search for
    * @return {item or nullptr, if found}
    */
-  virtual std::pair<Item, bool> getItem(const std::string name) const {
-    for (auto s : stack) {
-      auto [val, found] = getInScope(name, s);
+  virtual std::pair<Item, bool> getItem(const std::string& name) const {
+    for (const auto& s : stack) {
+      auto [val, found] = getInScope(name, *s);
       if (found) {
         DEBUG_SYMTABLE(1, FMT("[symtable]: Successfully fetched %s", name.c_str()).c_str())
         return {val, true};
@@ -96,7 +105,7 @@ public:
    * @param s scope where search is performed
    * @return {item or nullptr, if found}
    */
-  virtual std::pair<Item, bool> getInScope(const std::string name, Scope s) const {
+  virtual std::pair<Item, bool> getInScope(const std::string& name, const Scope& s) const {
     auto val = s.find(name);
     if (val != s.end()) { return {val->second, true}; }
 
@@ -108,17 +117,15 @@ public:
    * @param name  Item to search for
    * @return {item or nullptr, if found}
    */
-  virtual std::pair<Item, bool> getInCurrentScope(const std::string name) const {
-    return getInScope(name, currentScope());
+  virtual std::pair<Item, bool> getInCurrentScope(const std::string& name) const {
+    return getInScope(name, *currentScope());
   }
   /// @return the current scope the programm is into
-  virtual Scope currentScope() const { return stack.front(); }
+  virtual std::shared_ptr<Scope> currentScope() const { return stack.front(); }
   /// @brief Create a new scope and append it.
   virtual void addScope() {
     DEBUG_SYMTABLE(0, "Creating new scope")
-
-    Scope newScope{};
-    stack.insert(stack.begin(), newScope);
+    stack.push_front(std::make_shared<Scope>());
   }
   /// @brief Run a function inside a scope
   void withScope(std::function<void()> func) {
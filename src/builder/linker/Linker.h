@@ -61,6 +61,11 @@ public:
    * @param[in] args A reference to a vector of strings containing additional linker arguments.
    */
   int link(std::string& input, std::string& output, std::vector<std::string>& args);
+  /**
+   * @brief Links multiple object files together into a single executable.
+   * @see Linker::link
+   */
+  int link(std::vector<std::string>& inputs, std::string& output, std::vector<std::string>& args);
   /**
    * @brief Adds a library to the list of linked libraries.
    *
@@ -75,8 +80,18 @@ public:
    * @brief It returns the name for a shared library.
    */
   static std::string getSharedLibraryName(std::string& library);
+  /**
+   * @brief Find a library the same way the linker would (`-l:<name>`) in
+   *  the library search paths. If it's not there, the usual `lib<name>`
+   *  shared library naming convention is tried as well.
+   *
+   * @return The path to the library or an empty string if not found.
+   */
+  static std::string findLibrary(const std::string& library);
 
 private:
+  /// @return The folders where libraries are searched for (`-L`).
+  static std::vector<std::string> getLibrarySearchPaths();
   /**
    * @brief Constructs the linker arguments based on input, output, and additional arguments.
    *
@@ -84,11 +99,31 @@ private:
    * output file name, and additional arguments. The resulting linker arguments are stored
    * in the internal linkerArgs vector.
    *
-   * @param[in] input A reference to a string representing the input file name.
+   * @param[in] inputs A reference to a vector of strings representing the input file names.
    * @param[in] output A reference to a string representing the output file name.
    * @param[in] args A reference to a vector of strings containing additional linker arguments.
    */
-  void constructLinkerArgs(std::string& input, std::string& output, std::vector<std::string>& args);
+  void constructLinkerArgs(std::vector<std::string>& inputs, std::string& output, std::vector<std::string>& args);
+  /**
+   * @brief Whether the executable is linked in-process by LLD instead of
+   *  spawning the system linker. Only available for ELF targets and
+   *  when snowball is built with `SNOWBALL_USE_LLD`.
+   */
+  bool shouldUseLLD();
+  /**
+   * @brief Links the executable with LLD (as a library) using the already
+   *  constructed linker arguments.
+   *
+   * @param[out] errors The diagnostics LLD reported while linking.
+   * @return The exit status of the link.
+   */
+  int linkWithLLD(std::string& errors);
+  /**
+   * @brief Get compiler-rt's profile runtime, needed by the programs built
+   *  with `-profile-generate`. It's `$SNOWBALL_PROFILE_RUNTIME` if set or the
+   *  one found next to LLVM when snowball got built otherwise.
+   */
+  std::string getProfileRuntime();
   /**
    * @brief Transform an llvm triple into a platform triple.
    *
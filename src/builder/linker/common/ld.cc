@@ -4,6 +4,9 @@
 
 #include <llvm/Support/Host.h>
 
+#include <cstdlib>
+#include <filesystem>
+
 namespace snowball {
 namespace linker {
 
@@ -13,10 +16,28 @@ Linker::Linker(GlobalContext* ctx, std::string ldPath) : ctx(ctx), ldPath(ldPath
 void Linker::addLibrary(std::string& library) { linkedLibraries.push_back(library); }
 
 int Linker::link(std::string& input, std::string& output, std::vector<std::string>& args) {
+  std::vector<std::string> inputs = {input};
+  return link(inputs, output, args);
+}
+
+int Linker::link(std::vector<std::string>& inputs, std::string& output, std::vector<std::string>& args) {
   auto current = utils::get_lib_folder();
   rpaths.insert(rpaths.begin(), (current / ".." / "lib").string());
 
-  constructLinkerArgs(input, output, args);
+  constructLinkerArgs(inputs, output, args);
+  if (shouldUseLLD()) {
+    DEBUG_CODEGEN("Invoking linker (in-process LLD with stdlib at " STATICLIB_DIR ")");
+    DEBUG_CODEGEN("Linker arguments: %s", utils::join(linkerArgs.begin(), linkerArgs.end(), " ").c_str());
+    std::string errors;
+    int ldstatus = linkWithLLD(errors);
+    while (!errors.empty() && errors.back() == '\n') errors.pop_back();
+    if (ldstatus) throw SNError(LINKER_ERR, Logger::format("Linking with LLD failed:\n%s", errors.c_str()));
+    // Warnings don't make the link fail, but they still have to be shown
+    // just like the system linker would.
+    if (!errors.empty()) Logger::elog(errors);
+    return EXIT_SUCCESS;
+  }
+
   linkerArgs.insert(linkerArgs.begin(), ldPath);
   DEBUG_CODEGEN("Invoking linker (" LD_PATH " with stdlib at " STATICLIB_DIR ")");
   DEBUG_CODEGEN("Linker command: %s", utils::join(linkerArgs.begin(), linkerArgs.end(), " ").c_str());
@@ -30,6 +51,38 @@ int Linker::link(std::string& input, std::string& output, std::vector<std::strin
   return EXIT_SUCCESS;
 }
 
+std::string Linker::findLibrary(const std::string& library) {
+  namespace fs = std::filesystem;
+  if (library.find('/') != std::string::npos) return fs::exists(library) ? library : "";
+
+  auto conventional = "lib" + library;
+  conventional = getSharedLibraryName(conventional);
+  for (auto& name : {library, conventional}) {
+    for (auto& folder : getLibrarySearchPaths()) {
+      auto path = fs::path(folder) / name;
+      if (fs::is_regular_file(path)) return path.string();
+    }
+  }
+
+  return "";
+}
+
+std::string Linker::getProfileRuntime() {
+  std::string runtime = _SNOWBALL_PROFILE_RUNTIME;
+  if (auto path = getenv("SNOWBALL_PROFILE_RUNTIME")) runtime = path;
+  if (runtime.empty() || !std::filesystem::exists(runtime)) {
+    throw SNError(
+            LINKER_ERR,
+            FMT("Could not find compiler-rt's profile runtime (needed by -profile-generate)\n%shelp%s: set "
+                "SNOWBALL_PROFILE_RUNTIME to the path of libclang_rt.profile",
+                BGRN,
+                RESET)
+    );
+  }
+
+  return runtime;
+}
+
 std::string Linker::getPlatformTriple() {
   switch (target.getArch()) {
     case llvm::Triple::arm:
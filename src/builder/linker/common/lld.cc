@@ -0,0 +1,48 @@
+#include "../../../constants.h"
+#include "../../../utils/parallel.h"
+#include "../../../utils/utils.h"
+#include "../Linker.h"
+
+#if _SNOWBALL_USE_LLD
+#include <lld/Common/CommonLinkerContext.h>
+#include <lld/Common/Driver.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <mutex>
+#endif
+
+namespace snowball {
+namespace linker {
+
+bool Linker::shouldUseLLD() {
+#if _SNOWBALL_USE_LLD
+  return !ctx->systemLinker && target.isOSBinFormatELF();
+#else
+  return false;
+#endif
+}
+
+int Linker::linkWithLLD(std::string& errors) {
+#if _SNOWBALL_USE_LLD
+  // LLD keeps its state in globals, so only one link can happen at a time.
+  static std::mutex lldMutex;
+  std::lock_guard<std::mutex> lock(lldMutex);
+
+  std::vector<std::string> extraArgs = {"--threads=" + std::to_string(utils::getJobCount(ctx->codegenJobs))};
+  std::vector<const char*> args = {"ld.lld"};
+  for (auto& arg : linkerArgs) args.push_back(arg.c_str());
+  for (auto& arg : extraArgs) args.push_back(arg.c_str());
+
+  llvm::raw_string_ostream errorStream(errors);
+  bool success = lld::elf::link(args, llvm::outs(), errorStream, /* exitEarly */ false, /* disableOutput */ false);
+  errorStream.flush();
+  lld::CommonLinkerContext::destroy();
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+  assert(false && "snowball was not built with LLD support!");
+  return EXIT_FAILURE;
+#endif
+}
+
+} // namespace linker
+} // namespace snowball
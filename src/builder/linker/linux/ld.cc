@@ -4,6 +4,7 @@
 #include "../../../ast/errors/error.h"
 #include "../../../constants.h"
 #include "../Linker.h"
+#include <cstdio>
 #include <dlfcn.h>
 
 #include <filesystem>
@@ -12,7 +13,42 @@ namespace fs = std::filesystem;
 namespace snowball {
 namespace linker {
 
-void Linker::constructLinkerArgs(std::string& input, std::string& output, std::vector<std::string>& args) {
+namespace {
+/// @brief Look for one of libc's startup objects (crt1.o, crti.o, ...)
+///  in the same folders the system's compiler driver would.
+std::string findStartupFile(const std::string& name, const std::string& triple) {
+  for (auto folder : {"/usr/lib/" + triple, "/lib/" + triple, std::string("/usr/lib64"), std::string("/lib64"),
+                      std::string("/usr/lib"), std::string("/lib")}) {
+    auto path = fs::path(folder) / name;
+    if (fs::exists(path)) return path.string();
+  }
+  Syntax::E<LINKER_ERR>(FMT("Could not find '%s' in the system library folders", name.c_str()));
+  return "";
+}
+
+/// @brief Ask the system's GCC driver where its support libraries
+///  (libgcc, libstdc++...) are installed. The folder depends on the
+///  target triple and on the installed GCC version.
+/// @return The folder or an empty string if there's no GCC to ask.
+std::string findGCCLibraryFolder() {
+  for (auto driver : {"gcc", "cc"}) {
+    auto command = std::string(driver) + " -print-libgcc-file-name 2>/dev/null";
+    auto pipe = popen(command.c_str(), "r");
+    if (!pipe) continue;
+    std::string output;
+    char buffer[512];
+    while (fgets(buffer, sizeof(buffer), pipe)) output += buffer;
+    pclose(pipe);
+    while (!output.empty() && (output.back() == '\n' || output.back() == '\r')) output.pop_back();
+    // The driver just echoes the file name back when it doesn't know where it is.
+    auto path = fs::path(output);
+    if (path.is_absolute() && fs::exists(path)) return fs::canonical(path).parent_path().string();
+  }
+  return "";
+}
+} // namespace
+
+void Linker::constructLinkerArgs(std::vector<std::string>& inputs, std::string& output, std::vector<std::string>& args) {
   const bool isIAMCU = target.isOSIAMCU();
   linkerArgs.clear();
   if (ctx->isDynamic) {
@@ -46,52 +82,13 @@ void Linker::constructLinkerArgs(std::string& input, std::string& output, std::v
     }
     linkerArgs.push_back(ld_linux_path);
 
-    auto path = std::string("/usr") + PATH_SEPARATOR + _SNOWBALL_LIBRARY_OBJ;
     auto triple = getPlatformTriple();
     assert(!triple.empty() && "Unsupported platform for linking!");
 
-    if (!dlopen("crt1.o", RTLD_LAZY)) {
-      // dlopen returns `<absolute path>/crt1.o: only ET_DYN and ET_EXEC can be loaded`
-      // this is abusing that fact to get the absolute path
-      std::string err = dlerror();
-      std::size_t delim = err.find(':');
-      if (delim != std::string::npos) {
-        linkerArgs.push_back(err.substr(0, delim));
-      } else {
-        Syntax::E<LINKER_ERR>(err);
-      }
-    } else {
-      Syntax::E<LINKER_ERR>("crt1.o was loaded as a shared library");
-    }
-
-    if (!dlopen("crti.o", RTLD_LAZY)) {
-      // dlopen returns `<absolute path>/crt1.o: only ET_DYN and ET_EXEC can be loaded`
-      // this is abusing that fact to get the absolute path
-      std::string err = dlerror();
-      std::size_t delim = err.find(':');
-      if (delim != std::string::npos) {
-        linkerArgs.push_back(err.substr(0, delim));
-      } else {
-        Syntax::E<LINKER_ERR>(err);
-      }
-    } else {
-      Syntax::E<LINKER_ERR>("crti.o was loaded as a shared library");
-    }
-
+    linkerArgs.push_back(findStartupFile("crt1.o", triple));
+    linkerArgs.push_back(findStartupFile("crti.o", triple));
     if (!isIAMCU) {
-      if (!dlopen("crtn.o", RTLD_LAZY)) {
-        // dlopen returns `<absolute path>/crt1.o: only ET_DYN and ET_EXEC can be loaded`
-        // this is abusing that fact to get the absolute path
-        std::string err = dlerror();
-        std::size_t delim = err.find(':');
-        if (delim != std::string::npos) {
-          linkerArgs.push_back(err.substr(0, delim));
-        } else {
-          Syntax::E<LINKER_ERR>(err);
-        }
-      } else {
-        Syntax::E<LINKER_ERR>("crtn.o was loaded as a shared library");
-      }
+      linkerArgs.push_back(findStartupFile("crtn.o", triple));
     } else {
       // TODO: add crtbegin.o and crtend.o
     }
@@ -101,20 +98,18 @@ void Linker::constructLinkerArgs(std::string& input, std::string& output, std::v
     DEBUG_CODEGEN("Linking library: %s", lib.c_str());
   }
   if (ctx->withCXXStd) {
-    auto libs = utils::get_lib_folder() / ".." / _SNOWBALL_LIBRARY_OBJ;
-    linkerArgs.push_back("-L/usr/lib/../lib64");
-    linkerArgs.push_back("-L/lib/../lib64");
-    linkerArgs.push_back("-L/usr/bin/../lib/gcc/x86_64-linux-gnu/12");
-    linkerArgs.push_back("-L/usr/lib/x86_64-linux-gnu");
-    linkerArgs.push_back("-L/lib/x86_64-linux-gnu");
-    linkerArgs.push_back("-L/lib");
-    linkerArgs.push_back("-L/usr/lib");
+    for (auto& folder : getLibrarySearchPaths()) linkerArgs.push_back("-L" + folder);
     linkerArgs.push_back("-lsnowballrt");
     linkerArgs.push_back("-lm");
     linkerArgs.push_back("-lc");
-    linkerArgs.push_back("-L" + libs.string());
   }
-  linkerArgs.push_back(input);
+  for (auto& input : inputs) linkerArgs.push_back(input);
+  if (ctx->profile.mode == app::Options::ProfileOptions::GENERATE) {
+    // The runtime writes the profile once the program exits. It's only pulled
+    // in if something references it, which instrumented code doesn't on linux.
+    linkerArgs.push_back(getProfileRuntime());
+    linkerArgs.push_back("-u__llvm_profile_runtime");
+  }
   if (ctx->isThreaded) linkerArgs.push_back("-lpthread");
   for (auto& arg : args) linkerArgs.push_back(arg);
   // TODO: should this be with ctc->withStd?
@@ -133,6 +128,18 @@ void Linker::constructLinkerArgs(std::string& input, std::string& output, std::v
 
 std::string Linker::getSharedLibraryName(std::string& library) { return library + ".so"; }
 
+std::vector<std::string> Linker::getLibrarySearchPaths() {
+  auto libs = utils::get_lib_folder() / ".." / _SNOWBALL_LIBRARY_OBJ;
+  // Spawning the driver is slow compared to the rest of this, and the
+  // paths are needed for every library lookup.
+  static const std::string gccLibs = findGCCLibraryFolder();
+  std::vector<std::string> paths = {"/usr/lib/../lib64", "/lib/../lib64"};
+  if (!gccLibs.empty()) paths.push_back(gccLibs);
+  for (auto folder : {"/usr/lib/x86_64-linux-gnu", "/lib/x86_64-linux-gnu", "/lib", "/usr/lib"}) paths.push_back(folder);
+  paths.push_back(libs.string());
+  return paths;
+}
+
 } // namespace linker
 } // namespace snowball
 
@@ -11,7 +11,7 @@ namespace fs = std::filesystem;
 namespace snowball {
 namespace linker {
 
-void Linker::constructLinkerArgs(std::string& input, std::string& output, std::vector<std::string>& args) {
+void Linker::constructLinkerArgs(std::vector<std::string>& inputs, std::string& output, std::vector<std::string>& args) {
   const bool isIAMCU = target.isOSIAMCU();
   linkerArgs.clear();
   for (auto& lib : linkedLibraries) {
@@ -23,7 +23,9 @@ void Linker::constructLinkerArgs(std::string& input, std::string& output, std::v
     linkerArgs.push_back("-L" + libs.string());
     linkerArgs.push_back("-lsnowballrt");
   }
-  linkerArgs.push_back(input);
+  for (auto& input : inputs) linkerArgs.push_back(input);
+  // The runtime writes the profile once the program exits
+  if (ctx->profile.mode == app::Options::ProfileOptions::GENERATE) linkerArgs.push_back(getProfileRuntime());
   for (auto& arg : args) linkerArgs.push_back(arg);
   if (ctx->withStd) {
     for (auto llvmArg : utils::split(LLVM_LDFLAGS, " ")) { linkerArgs.push_back(llvmArg); }
@@ -54,6 +56,11 @@ void Linker::constructLinkerArgs(std::string& input, std::string& output, std::v
 
 std::string Linker::getSharedLibraryName(std::string& library) { return library + ".dylib"; }
 
+std::vector<std::string> Linker::getLibrarySearchPaths() {
+  auto libs = utils::get_lib_folder() / ".." / _SNOWBALL_LIBRARY_OBJ;
+  return {libs.string(), ".", "/opt/homebrew/lib", "/usr/local/lib", "/usr/lib"};
+}
+
 } // namespace linker
 } // namespace snowball
 
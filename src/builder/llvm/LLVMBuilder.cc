@@ -2,6 +2,7 @@
 #include "LLVMBuilder.h"
 
 #include "../../errors.h"
+#include "../../utils/utils.h"
 
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/IR/DIBuilder.h>
@@ -35,6 +36,7 @@
 #include <llvm/LinkAllIR.h>
 #include <llvm/LinkAllPasses.h>
 #include <llvm/Linker/Linker.h>
+#include <llvm/MC/MCSubtargetInfo.h>
 #include <llvm/MC/TargetRegistry.h>
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/Support/Allocator.h>
@@ -68,6 +70,10 @@
 #include <llvm/Transforms/Utils/Cloning.h>
 #include <llvm/Transforms/Utils/Debugify.h>
 
+#include <algorithm>
+#include <map>
+#include <mutex>
+
 namespace snowball {
 using namespace utils;
 
@@ -100,68 +106,143 @@ llvm::Value* LLVMBuilder::load(llvm::Value* v, types::Type* ty) {
   return v;
 }
 
+void LLVMBuilder::initializeLLVM() {
+  static std::once_flag initialized;
+  std::call_once(initialized, [] {
+    llvm::InitializeAllTargetInfos();
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmParsers();
+    llvm::InitializeAllAsmPrinters();
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    llvm::InitializeNativeTargetAsmParser();
+
+    // Initialize passes
+    auto& registry = *llvm::PassRegistry::getPassRegistry();
+    llvm::initializeCore(registry);
+    llvm::initializeScalarOpts(registry);
+    llvm::initializeVectorization(registry);
+    llvm::initializeIPO(registry);
+    llvm::initializeAnalysis(registry);
+    llvm::initializeTransformUtils(registry);
+    llvm::initializeInstCombine(registry);
+    llvm::initializeXRayInstrumentationPass(registry);
+    llvm::initializeTarget(registry);
+
+    llvm::initializeExpandMemCmpPassPass(registry);
+    llvm::initializeScalarizeMaskedMemIntrinLegacyPassPass(registry);
+    llvm::initializeSelectOptimizePass(registry);
+    llvm::initializeCodeGenPreparePass(registry);
+    llvm::initializeAtomicExpandPass(registry);
+    llvm::initializeMergeICmpsLegacyPassPass(registry);
+    llvm::initializeWinEHPreparePass(registry);
+    llvm::initializeDwarfEHPrepareLegacyPassPass(registry);
+    llvm::initializeSafeStackLegacyPassPass(registry);
+    llvm::initializeSjLjEHPreparePass(registry);
+    llvm::initializePreISelIntrinsicLoweringLegacyPassPass(registry);
+    llvm::initializeGlobalMergePass(registry);
+    llvm::initializeIndirectBrExpandPassPass(registry);
+    llvm::initializeInterleavedLoadCombinePass(registry);
+    llvm::initializeInterleavedAccessPass(registry);
+    llvm::initializeUnreachableBlockElimLegacyPassPass(registry);
+    llvm::initializeExpandReductionsPass(registry);
+    llvm::initializeExpandVectorPredicationPass(registry);
+    llvm::initializeWasmEHPreparePass(registry);
+    llvm::initializeWriteBitcodePassPass(registry);
+    llvm::initializeHardwareLoopsPass(registry);
+    llvm::initializeReplaceWithVeclibLegacyPass(registry);
+    llvm::initializeTypePromotionLegacyPass(registry);
+  });
+}
+
 LLVMBuilder::LLVMBuilder(
-        std::shared_ptr<ir::MainModule> mod, app::Options::Optimization optimizationLevel, bool testMode, bool benchMode
+        std::shared_ptr<ir::MainModule> mod,
+        app::Options::Optimization optimizationLevel,
+        bool testMode,
+        bool benchMode,
+        std::shared_ptr<ir::Module> codegenUnit,
+        app::Options::TargetOptions targetOptions
 )
-    : iModule(mod) {
+    : iModule(mod), codegenUnit(codegenUnit), targetOptions(targetOptions) {
   ctx->testMode = testMode;
   ctx->benchmarkMode = benchMode;
   ctx->optimizationLevel = optimizationLevel;
   dbg.debug = ctx->optimizationLevel == app::Options::Optimization::OPTIMIZE_O0;
-  llvm::InitializeAllTargetInfos();
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmParsers();
-  llvm::InitializeAllAsmPrinters();
-  llvm::InitializeNativeTarget();
-  llvm::InitializeNativeTargetAsmPrinter();
-  llvm::InitializeNativeTargetAsmParser();
-
-  // Initialize passes
-  auto& registry = *llvm::PassRegistry::getPassRegistry();
-  llvm::initializeCore(registry);
-  llvm::initializeScalarOpts(registry);
-  llvm::initializeVectorization(registry);
-  llvm::initializeIPO(registry);
-  llvm::initializeAnalysis(registry);
-  llvm::initializeTransformUtils(registry);
-  llvm::initializeInstCombine(registry);
-  llvm::initializeXRayInstrumentationPass(registry);
-  llvm::initializeTarget(registry);
-
-  llvm::initializeExpandMemCmpPassPass(registry);
-  llvm::initializeScalarizeMaskedMemIntrinLegacyPassPass(registry);
-  llvm::initializeSelectOptimizePass(registry);
-  llvm::initializeCodeGenPreparePass(registry);
-  llvm::initializeAtomicExpandPass(registry);
-  llvm::initializeMergeICmpsLegacyPassPass(registry);
-  llvm::initializeWinEHPreparePass(registry);
-  llvm::initializeDwarfEHPrepareLegacyPassPass(registry);
-  llvm::initializeSafeStackLegacyPassPass(registry);
-  llvm::initializeSjLjEHPreparePass(registry);
-  llvm::initializePreISelIntrinsicLoweringLegacyPassPass(registry);
-  llvm::initializeGlobalMergePass(registry);
-  llvm::initializeIndirectBrExpandPassPass(registry);
-  llvm::initializeInterleavedLoadCombinePass(registry);
-  llvm::initializeInterleavedAccessPass(registry);
-  llvm::initializeUnreachableBlockElimLegacyPassPass(registry);
-  llvm::initializeExpandReductionsPass(registry);
-  llvm::initializeExpandVectorPredicationPass(registry);
-  llvm::initializeWasmEHPreparePass(registry);
-  llvm::initializeWriteBitcodePassPass(registry);
-  llvm::initializeHardwareLoopsPass(registry);
-  llvm::initializeReplaceWithVeclibLegacyPass(registry);
-  llvm::initializeTypePromotionLegacyPass(registry);
-
+  initializeLLVM();
   newContext();
   module = newModule();
 }
 
+namespace {
+// Target machines created ahead of time (see `warmTargetMachine`), keyed
+// by the CPU and features they were created for.
+std::mutex warmTargetsMutex;
+std::multimap<std::pair<std::string, std::string>, llvm::TargetMachine*> warmTargets;
+} // namespace
+
+void LLVMBuilder::warmTargetMachine(app::Options::TargetOptions options) {
+  initializeLLVM();
+  auto machine = createTargetMachine(options);
+  std::lock_guard lock(warmTargetsMutex);
+  warmTargets.insert({{options.cpu, options.features}, machine});
+}
+
+llvm::TargetMachine* LLVMBuilder::acquireTargetMachine() {
+  {
+    // A machine is only ever used by a single builder, since builders
+    // optimize and emit in parallel.
+    std::lock_guard lock(warmTargetsMutex);
+    auto it = warmTargets.find({targetOptions.cpu, targetOptions.features});
+    if (it != warmTargets.end()) {
+      auto machine = it->second;
+      warmTargets.erase(it);
+      return machine;
+    }
+  }
+
+  return createTargetMachine(targetOptions);
+}
+
+llvm::TargetMachine* LLVMBuilder::createTargetMachine(const app::Options::TargetOptions& targetOptions) {
+  auto cpu = targetOptions.cpu;
+  if (cpu == "native") cpu = llvm::sys::getHostCPUName().str();
+
+  std::vector<std::string> features;
+  auto addHostFeatures = [&] {
+    llvm::StringMap<bool> hostFeatures;
+    if (!llvm::sys::getHostCPUFeatures(hostFeatures)) return;
+    for (auto& feature : hostFeatures) features.push_back((feature.second ? "+" : "-") + feature.first().str());
+  };
+
+  // The host's CPU is pointless without the features it supports
+  if (targetOptions.cpu == "native" && targetOptions.features.empty()) addHostFeatures();
+  for (auto feature : utils::split(targetOptions.features, ",")) {
+    feature.erase(std::remove_if(feature.begin(), feature.end(), ::isspace), feature.end());
+    if (feature.empty()) continue;
+    if (feature == "native") addHostFeatures();
+    else features.push_back(feature[0] == '+' || feature[0] == '-' ? feature : "+" + feature);
+  }
+
+  auto engine = llvm::EngineBuilder();
+  engine.setMCPU(cpu);
+  engine.setMAttrs(features);
+  auto machine = engine.selectTarget();
+  if (!machine) throw SNError(Error::LLVM_INTERNAL, "Could not create a target machine for this host");
+  if (!cpu.empty() && !machine->getMCSubtargetInfo()->isCPUStringValid(cpu)) {
+    throw SNError(
+            Error::CONFIGURATION_ERROR,
+            FMT("Unknown target CPU '%s' for %s", cpu.c_str(), machine->getTargetTriple().str().c_str())
+    );
+  }
+
+  return machine;
+}
+
 std::unique_ptr<llvm::Module> LLVMBuilder::newModule() {
   auto m = std::make_unique<llvm::Module>("snowball compiled project", *context);
 
-  auto engine = llvm::EngineBuilder();
-  target = engine.selectTarget();
+  target = acquireTargetMachine();
 
   m->setDataLayout(target->createDataLayout());
   m->setTargetTriple(target->getTargetTriple().str());
@@ -169,6 +250,10 @@ std::unique_ptr<llvm::Module> LLVMBuilder::newModule() {
   builder = std::make_unique<llvm::IRBuilder<>>(*context);
 
   auto srcInfo = iModule->getSourceInfo();
+  if (codegenUnit && codegenUnit->getSourceInfo()) {
+    srcInfo = codegenUnit->getSourceInfo();
+    m->setModuleIdentifier(codegenUnit->getUniqueName());
+  }
   m->setSourceFileName(srcInfo->getPath());
 
   // debug info setup
@@ -217,6 +302,12 @@ llvm::DIFile* LLVMBuilder::DebugInfo::getFile(const std::string& path) {
 
 void LLVMBuilder::dump() { this->print(llvm::errs()); }
 void LLVMBuilder::print(llvm::raw_fd_ostream& s) { module->print(s, nullptr); }
+uint64_t LLVMBuilder::getModuleHash() {
+  std::string ir;
+  llvm::raw_string_ostream os(ir);
+  module->print(os, nullptr);
+  return utils::hashString(os.str());
+}
 
 #define ITERATE_FUNCTIONS for (auto fn = functions.begin(); fn != functions.end(); ++fn)
 #define ITERATE_RFUNCTIONS for (auto fn = functions.rbegin(); fn != functions.rend(); ++fn)
@@ -290,6 +381,13 @@ void LLVMBuilder::codegen() {
     }
   };
 
+  // Declare the variables of a module that is generated by another
+  // codegen unit.
+  auto declareModule = [&](std::shared_ptr<ir::Module> m) {
+    this->iModule = m;
+    for (auto v : m->getVariables()) { declareGlobalVariable(v); }
+  };
+
   auto mainModule = utils::dyn_cast<ir::MainModule>(iModule);
   assert(mainModule);
 
@@ -297,25 +395,64 @@ void LLVMBuilder::codegen() {
   for (auto m : mainModule->getModules()) generateModule(m, build);                                                    \
   generateModule(mainModule, build);
 
+  // Types are owned by the first module that defines them.
+  std::map<ir::id_t, ir::Module*> typeOwners;
   for (const auto& m : mainModule->getModules()) {
     ctx->typeInfo.insert(m->typeInformation.begin(), m->typeInformation.end());
+    for (const auto& ty : m->typeInformation) typeOwners.insert({ty.first, m.get()});
   }
   ctx->typeInfo.insert(mainModule->typeInformation.begin(), mainModule->typeInformation.end());
+  for (const auto& ty : mainModule->typeInformation) typeOwners.insert({ty.first, mainModule.get()});
 
+  if (codegenUnit) this->iModule = codegenUnit;
   for (const auto& ty : ctx->typeInfo) {
     auto t = ty.second.get();
     if (auto c = utils::cast<types::DefinedType>(t)) {
       auto& staticFields = c->getStaticFields();
       for (auto& f : staticFields) {
-        addGlobalVariable(f, c);
+        if (codegenUnit && typeOwners.at(ty.first) != codegenUnit.get()) {
+          declareGlobalVariable(f, c);
+        } else {
+          addGlobalVariable(f, c);
+        }
       }
     }
   }
 
   INIT_MODULES(false); // Create function declarations
-  INIT_MODULES(true);  // Create function bodies
+  if (codegenUnit) {
+    // Only the bodies of the current unit are generated. Everything else
+    // is just referenced and will be resolved once the objects of the
+    // other units get linked together.
+    for (auto m : mainModule->getModules()) {
+      if (m != codegenUnit) declareModule(m);
+    }
+    if (mainModule != codegenUnit) declareModule(mainModule);
+    generateModule(codegenUnit, true);
+
+    // Inline LLVM functions are always private, so every unit needs its
+    // own copy of the ones it uses.
+    auto allModules = mainModule->getModules();
+    allModules.push_back(mainModule);
+    for (auto m : allModules) {
+      if (m == codegenUnit) continue;
+      this->iModule = m;
+      for (auto f : m->getFunctions()) {
+        if (f->isDeclaration() || f->hasAttribute(Attributes::BUILTIN) || !f->hasAttribute(Attributes::LLVM_FUNC)) continue;
+        auto llvmFn = funcs.at(f->getId());
+        if (!llvmFn->use_empty()) funcs.at(f->getId()) = buildLLVMFunction(llvmFn, f.get());
+      }
+    }
+
+    // Declarations can't have a distinct debug subprogram attached.
+    for (auto& f : *module) {
+      if (f.isDeclaration()) f.setSubprogram(nullptr);
+    }
+  } else {
+    INIT_MODULES(true); // Create function bodies
+  }
 
-  initializeRuntime();
+  if (!codegenUnit || codegenUnit == mainModule) initializeRuntime();
   dbg.builder->finalize();
 
   DEBUG_CODEGEN("Finished codegen, proceeding to verify module");
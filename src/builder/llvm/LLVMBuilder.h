@@ -129,7 +129,26 @@ public:
     llvm::BasicBlock* continueBlock = nullptr;
     // The break block for the current loop
     llvm::BasicBlock* breakBlock = nullptr;
+    // Amount of scopes alive when the loop started
+    size_t scopeDepth = 0;
   } loop;
+  /// @brief An object that has to be destroyed when its scope ends
+  struct ScopedObject {
+    // Storage holding the object
+    llvm::Value* storage = nullptr;
+    // Flag set while the object is alive
+    llvm::Value* alive = nullptr;
+    // Destructor to call
+    ir::Func* destructor = nullptr;
+  };
+  /// @brief Objects to destroy, for each scope of the current function
+  std::vector<std::vector<ScopedObject>> scopes;
+  /// @brief Every object owned by the current function along with the id
+  ///  of its variable, in declaration order
+  std::vector<std::pair<ir::id_t, ScopedObject>> ownedObjects;
+  /// @brief Landing pad destroying the owned objects of the current function
+  ///  when an exception unwinds out of it (created on demand)
+  llvm::BasicBlock* cleanupBlock = nullptr;
 };
 
 /**
@@ -143,6 +162,8 @@ class LLVMBuilder : AcceptorExtend<LLVMBuilder, ValueVisitor> {
   // A global map to keep track of all processed
   // functions.
   std::map<ir::id_t, llvm::Function*> funcs;
+  // Destructors declared for each type (by type id)
+  std::map<ir::id_t, ir::Func*> destructors;
   // Some sort of cache to prevent struct-like types
   // from being generated over and over again.
   std::map<ir::id_t, llvm::Type*> types;
@@ -213,6 +234,8 @@ class LLVMBuilder : AcceptorExtend<LLVMBuilder, ValueVisitor> {
     std::vector<std::shared_ptr<ir::VariableDeclaration>> catchVars;
     /// Stores the exception pad
     llvm::Value* exceptionPad = nullptr;
+    /// Objects created inside the try block, destroyed when unwinding
+    std::vector<LLVMBuilderContext::ScopedObject> objects;
   };
   /// A stack containing all the try-catch blocks
   std::vector<TryCatchInfo> tryCatchStack;
@@ -227,6 +250,17 @@ class LLVMBuilder : AcceptorExtend<LLVMBuilder, ValueVisitor> {
   llvm::Value* value;
   // Target machine that the module will be compiled into
   llvm::TargetMachine* target;
+  // CPU and features requested by the user (see `createTargetMachine`)
+  app::Options::TargetOptions targetOptions;
+  // Profile guided optimization (see `setProfile`)
+  app::Options::ProfileOptions::Mode profileMode = app::Options::ProfileOptions::NONE;
+  std::string profileFile;
+  // Custom optimization pipeline (e.g. "function(sroa,instcombine)"), it
+  // replaces the default one for the optimization level if not empty.
+  std::string passPipeline;
+  // The only module that will have its bodies generated. If it's
+  // null, the whole program is generated into a single LLVM module.
+  std::shared_ptr<ir::Module> codegenUnit = nullptr;
 
 public:
   // Create a new instance of a llvm builder
@@ -234,8 +268,37 @@ public:
           std::shared_ptr<ir::MainModule> mod,
           app::Options::Optimization optimizationLevel = app::Options::Optimization::OPTIMIZE_O0,
           bool testMode = false,
-          bool benchmarkMode = false
+          bool benchmarkMode = false,
+          std::shared_ptr<ir::Module> codegenUnit = nullptr,
+          app::Options::TargetOptions targetOptions = {}
   );
+  /**
+   * @brief Initialize the LLVM targets and passes used by the builder.
+   *
+   * It's called by every builder, but only does something the first time.
+   * Long running processes (e.g. `snowball server`) call it beforehand
+   * so that compilations don't have to pay for it.
+   */
+  static void initializeLLVM();
+  /**
+   * @brief Create a target machine for the given CPU and features ahead
+   *  of time. The next builder using the same options takes it instead of
+   *  creating its own.
+   * @note Used by `snowball server`, the processes it forks inherit it.
+   */
+  static void warmTargetMachine(app::Options::TargetOptions options);
+  /**
+   * @brief Optimize using a profile. With `GENERATE`, the module gets
+   *  instrumented to write its profile into @param file, with `USE` the
+   *  (indexed) profile at @param file drives inlining, block placement and
+   *  indirect call promotion.
+   */
+  void setProfile(app::Options::ProfileOptions::Mode mode, std::string file) {
+    profileMode = mode;
+    profileFile = file;
+  }
+  /// @brief Optimize with a custom pipeline, in the syntax used by `opt -passes`.
+  void setPassPipeline(std::string pipeline) { passPipeline = pipeline; }
   /**
    * @brief Dump the LLVM IR code to stdout.
    *
@@ -249,6 +312,19 @@ public:
    * @brief Print the llvm IR module into a stream
    */
   void print(llvm::raw_fd_ostream& s);
+  /**
+   * @brief Hash the generated LLVM IR module. Two modules with the same
+   *  hash will result in the same object file.
+   */
+  uint64_t getModuleHash();
+  /**
+   * @return The triple, CPU and features the module is compiled for
+   *  (with "native" already resolved to the host's).
+   */
+  std::string getTargetDescription() const {
+    return target->getTargetTriple().str() + ":" + target->getTargetCPU().str() + ":" +
+            target->getTargetFeatureString().str();
+  }
   /**
    * @brief get a type info struct type
    */
@@ -272,6 +348,15 @@ public:
    * desired file.
    */
   int emitObjectFile(std::string out, bool log, bool object = true);
+  /**
+   * @brief Execute the generated module in-process using a JIT compiler.
+   * @param args Arguments passed to the program's main function.
+   * @param libraries Shared libraries loaded to resolve external symbols.
+   * @return The program's exit code.
+   * @note The LLVM module is moved into the JIT, the builder can't be used
+   *  after calling this function.
+   */
+  int executeJIT(std::vector<std::string> args, std::vector<std::string> libraries);
   /**
    * @brief It builds a value as an expression.
    * @param v Value to build
@@ -294,6 +379,18 @@ private:
    * @return An unique ptr to a new module
    */
   std::unique_ptr<llvm::Module> newModule();
+  /**
+   * @brief Create the target machine for the host's architecture using
+   *  the CPU and features given by the user.
+   * @note If the features are "native" (or not given when the CPU is), the
+   *  features of the host are used.
+   */
+  static llvm::TargetMachine* createTargetMachine(const app::Options::TargetOptions& options);
+  /**
+   * @brief Take the target machine created ahead of time for our target
+   *  options (see `warmTargetMachine`) or create a new one.
+   */
+  llvm::TargetMachine* acquireTargetMachine();
   /**
    * @brief Utility function to create a new LLVM module context
    * @return An unique pointer to the new context.
@@ -336,6 +433,17 @@ private:
    * value for a virtual table for @param ty
    */
   llvm::GlobalVariable* createVirtualTable(types::BaseType* ty, llvm::StructType* vtableType);
+  /**
+   * @brief Whether vtables are annotated with type metadata (and virtual calls
+   *  with type tests) so that they can be devirtualized (see `optimizeModule`).
+   *
+   * That's only sound when every vtable of the program is inside of the module,
+   * so modules generated for a single codegen unit don't get it. Unoptimized
+   * builds don't either, since nothing would get devirtualized.
+   */
+  bool hasWholeProgramVtables() const { return !codegenUnit && !dbg.debug; }
+  /// @return The type identifier used in the type metadata of @param ty 's vtable.
+  llvm::MDString* getVtableTypeId(types::BaseType* ty);
   /**
    * @brief It creates a new enum type and a new constant struct
    * value for a virtual table for @param call
@@ -387,6 +495,30 @@ private:
    * depending on the current context.
    */
   llvm::Value* createCall(llvm::FunctionType* ty, llvm::Value* callee, llvm::ArrayRef<llvm::Value*> args);
+  /**
+   * @brief Registers the object stored in a variable to be destroyed
+   *  once the current scope ends, if its type has a destructor.
+   */
+  void addScopedObject(ir::VariableDeclaration* variable, llvm::Value* storage);
+  /**
+   * @brief Destroys every object alive in the scopes from @param depth
+   *  to the innermost one. The scopes themselves are kept.
+   */
+  void destroyScopes(size_t depth);
+  /**
+   * @brief Calls the destructor of an object if it's still alive.
+   */
+  void destroyObject(const LLVMBuilderContext::ScopedObject& object);
+  /**
+   * @brief Fills the cleanup landing pad of the current function (if any).
+   *  It destroys every owned object that is still alive and resumes unwinding.
+   */
+  void buildCleanupPad();
+  /**
+   * @return The object owned by the variable with the given id, if
+   *  the current function owns any.
+   */
+  const LLVMBuilderContext::ScopedObject* getOwnedObject(ir::id_t variable);
   /**
    * @brief It generates the LLVM IR contents that the user has
    *  manually inserted by using "inline LLVM".
@@ -424,6 +556,14 @@ private:
    * @param ty The type of the variable, or nullptr if the type should
    */
   void addGlobalVariable(std::shared_ptr<ir::VariableDeclaration> var, types::DefinedType* ty = nullptr);
+  /**
+   * Declare a global variable that is defined inside another codegen
+   * unit (@see LLVMBuilder::codegenUnit).
+   *
+   * @param var A shared pointer to the variable declaration.
+   * @param ty The type the variable belongs to (if it's a static field).
+   */
+  void declareGlobalVariable(std::shared_ptr<ir::VariableDeclaration> var, types::DefinedType* ty = nullptr);
   /**
    * Get the global constructor function.
    *
@@ -5,17 +5,47 @@
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
 
+#include <algorithm>
+
 namespace snowball {
 namespace codegen {
 
-void LLVMBuilder::addGlobalVariable(std::shared_ptr<ir::VariableDeclaration> var, types::DefinedType* parent) {
+namespace {
+// Symbol names must be the same for every codegen unit (and every build),
+// so that a variable defined in one object can be referenced from another one.
+std::string getGlobalVariableName(
+        std::shared_ptr<ir::VariableDeclaration> var, types::DefinedType* parent, std::shared_ptr<ir::Module> module
+) {
+  if (parent) return "const." + parent->getMangledName() + ":" + var->getIdentifier();
+  const auto& variables = module->getVariables();
+  auto index = std::distance(variables.begin(), std::find(variables.begin(), variables.end(), var));
+  return "gvar." + module->getUniqueName() + ":" + std::to_string(index) + ":" + var->getIdentifier();
+}
+} // namespace
+
+void LLVMBuilder::declareGlobalVariable(std::shared_ptr<ir::VariableDeclaration> var, types::DefinedType* parent) {
   auto ty = getLLVMType(var->getType());
-  std::string name;
-  if (parent) {
-    name = "const." + parent->getUUID() + ":" + utils::gen_random<32>() + ":" + var->getIdentifier();
-  } else {
-    name = "gvar." + iModule->getUniqueName() + ":" + utils::gen_random<32>() + ":" + var->getIdentifier();
+  auto name = var->isExternDecl() ? var->getIdentifier() : getGlobalVariableName(var, parent, iModule);
+  auto gvar = module->getNamedGlobal(name);
+  if (!gvar) {
+    gvar = new llvm::GlobalVariable(
+            /*Module=*/*module,
+            /*Type=*/ty,
+            /*isConstant=*/false,
+            /*Linkage=*/llvm::GlobalValue::ExternalLinkage,
+            /*Initializer=*/nullptr,
+            /*Name=*/name
+    );
   }
+  ctx->addSymbol(var->getId(), gvar);
+}
+
+void LLVMBuilder::addGlobalVariable(std::shared_ptr<ir::VariableDeclaration> var, types::DefinedType* parent) {
+  auto ty = getLLVMType(var->getType());
+  auto name = getGlobalVariableName(var, parent, iModule);
+  // Variables must be visible to the other units if we are only
+  // generating a part of the program.
+  auto linkage = codegenUnit ? llvm::GlobalValue::ExternalLinkage : llvm::GlobalValue::InternalLinkage;
 
   auto srcInfo = var->getDBGInfo();
   auto file = dbg.getFile(var->getSourceInfo()->getPath());
@@ -43,7 +73,7 @@ void LLVMBuilder::addGlobalVariable(std::shared_ptr<ir::VariableDeclaration> var
             /*Module=*/*module,
             /*Type=*/ty,
             /*isConstant=*/!var->getVariable()->isMutable(),
-            /*Linkage=*/llvm::GlobalValue::InternalLinkage,
+            /*Linkage=*/linkage,
             /*Initializer=*/llvm::cast<llvm::Constant>(c), // has initializer, specified below
             /*Name=*/name
     );
@@ -61,7 +91,7 @@ void LLVMBuilder::addGlobalVariable(std::shared_ptr<ir::VariableDeclaration> var
           /*Module=*/*module,
           /*Type=*/ty,
           /*isConstant=*/0,// !var->getVariable()->isMutable(),
-          /*Linkage=*/llvm::GlobalValue::InternalLinkage,
+          /*Linkage=*/linkage,
           /*Initializer=*/llvm::Constant::getNullValue(ty), // has initializer, specified below
           /*Name=*/name
   );
@@ -10,7 +10,12 @@ namespace snowball {
 namespace codegen {
 
 void LLVMBuilder::visit(ir::Block* block) {
+  ctx->scopes.emplace_back();
   for (auto i : block->getBlock()) build(i.get());
+  // Objects declared inside the block are destroyed once it ends. Blocks
+  // ending with a jump (e.g. return, break) already destroyed them.
+  if (!builder->GetInsertBlock()->getTerminator()) destroyScopes(ctx->scopes.size() - 1);
+  ctx->scopes.pop_back();
 }
 
 } // namespace codegen
@@ -11,6 +11,8 @@
 
 #include <llvm/IR/DerivedTypes.h>
 #include <llvm/IR/Function.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/Metadata.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
 
@@ -137,6 +139,14 @@ void LLVMBuilder::visit(ir::Call* call) {
     // class instance = { [0] = vtable, ... }
     // vtable = { [size x ptr] } { [0] = fn1, [1] = fn2, ... } }
     auto vtable = builder->CreateLoad(vtableType->getPointerTo(), parentValue);
+    if (hasWholeProgramVtables()) {
+      // Tell WholeProgramDevirt which vtables this one can be
+      auto typeTest = builder->CreateCall(
+              llvm::Intrinsic::getDeclaration(module.get(), llvm::Intrinsic::type_test),
+              {vtable, llvm::MetadataAsValue::get(*context, getVtableTypeId(definedType))}
+      );
+      builder->CreateAssumption(typeTest);
+    }
     auto fn = builder->CreateLoad(
             calleeType->getPointerTo(), builder->CreateConstInBoundsGEP1_32(vtableType->getPointerTo(), vtable, index)
     );
@@ -56,6 +56,8 @@ void LLVMBuilder::visit(ir::Cast* c) {
   } else if (IS_INTEGER(vTy) && utils::cast<types::PointerType>(ty)) { // i[n] -> *
     this->value = builder->CreateIntToPtr(v, llvmType);
     this->ctx->doNotLoadInMemory = true;
+  } else if (utils::cast<types::PointerType>(vTy) && IS_INTEGER(ty)) { // * -> i[n]
+    this->value = builder->CreatePtrToInt(v, llvmType);
   } else if (IS_DEFINED(vTy) && IS_DEFINED(ty)) {
     if (llvm::isa<llvm::LoadInst>(v)) {
       auto ptr = llvm::cast<llvm::LoadInst>(v)->getPointerOperand();
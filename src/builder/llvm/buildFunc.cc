@@ -22,9 +22,15 @@ void LLVMBuilder::visit(ir::Func* func) {
     if (!func->isAnon()) 
       this->value = it->second;
     else {
-      auto layout = module->getDataLayout();
-      auto alloca = builder->CreateCall(getAllocaFunction(), {builder->getInt32(layout.getTypeAllocSize(getLambdaContextType()))});
-      
+      llvm::Value* alloca = nullptr;
+      if (func->escapes()) {
+        auto layout = module->getDataLayout();
+        alloca = builder->CreateCall(getAllocaFunction(), {builder->getInt64(layout.getTypeAllocSize(getLambdaContextType()))});
+      } else {
+        // The lambda is only called inside this function (see EscapeAnalysis)
+        alloca = createAlloca(getLambdaContextType(), ".lambda-context");
+      }
+
       auto funcGep = builder->CreateStructGEP(getLambdaContextType(), alloca, 0, ".func.use.gep");
       builder->CreateStore(it->second, funcGep);
 
@@ -54,6 +60,10 @@ void LLVMBuilder::visit(ir::Func* func) {
   }
 
   funcs.insert({func->getId(), fn});
+  if (func->isDestructor()) {
+    auto self = func->getParent();
+    destructors.insert({utils::cast<types::BaseType>(self)->getId(), func});
+  }
   this->value = fn;
 }
 
@@ -138,8 +148,14 @@ llvm::Function* LLVMBuilder::buildBodiedFunction(llvm::Function* llvmFn, ir::Fun
   }
 
   if (closureType) {
-    auto layout = module->getDataLayout();
-    auto alloca = builder->CreateCall(getAllocaFunction(), {builder->getInt32(layout.getTypeAllocSize(closureType))});
+    llvm::Instruction* alloca = nullptr;
+    if (fn->closureEscapes()) {
+      auto layout = module->getDataLayout();
+      alloca = builder->CreateCall(getAllocaFunction(), {builder->getInt64(layout.getTypeAllocSize(closureType))});
+    } else {
+      // No lambda referencing the closure outlives this function (see EscapeAnalysis)
+      alloca = builder->CreateAlloca(closureType, nullptr, ".closure");
+    }
     //auto structAlloca = createAlloca(closureType->getPointerTo());
     alloca->setDebugLoc(llvm::DILocation::get(*context, 0, 0, llvmFn->getSubprogram()));
     //builder->CreateStore(alloca, structAlloca);
@@ -228,6 +244,7 @@ llvm::Function* LLVMBuilder::buildBodiedFunction(llvm::Function* llvmFn, ir::Fun
   builder->SetInsertPoint(body);
 
   // Codegen for the current body
+  assert(ctx->scopes.empty());
   (void) build(fn->getBody().get());
   setDebugInfoLoc(nullptr);
 
@@ -245,6 +262,8 @@ llvm::Function* LLVMBuilder::buildBodiedFunction(llvm::Function* llvmFn, ir::Fun
     }
   }
 
+  buildCleanupPad();
+
   // mark: clean up
   ctx->clearCurrentFunction();
   ctx->clearCurrentIRFunction();
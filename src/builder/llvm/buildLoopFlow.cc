@@ -9,6 +9,7 @@ namespace snowball {
 namespace codegen {
 
 void LLVMBuilder::visit(ir::LoopFlow* c) {
+  destroyScopes(ctx->loop.scopeDepth);
   switch (c->getFlowType()) {
     case ir::LoopFlowType::Break:
       builder->CreateBr(ctx->loop.breakBlock);
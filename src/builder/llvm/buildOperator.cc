@@ -4,6 +4,8 @@
 #include "../../ir/values/Func.h"
 #include "../../ir/values/IndexExtract.h"
 #include "../../ir/values/ReferenceTo.h"
+#include "../../ir/values/ValueExtract.h"
+#include "../../ir/values/Variable.h"
 #include "../../utils/utils.h"
 #include "LLVMBuilder.h"
 
@@ -259,7 +261,14 @@ bool LLVMBuilder::buildOperator(ir::Call* call) {
             //  builder->getInt64(args.at(0)->getType()->sizeOf()), 0); builder->CreateLifetimeEnd(a,
             //  builder->getInt64(args.at(0)->getType()->sizeOf()));
             //} else {
+            // Variables owning their object destroy the old one before taking
+            // ownership of the new one (see EscapeAnalysis).
+            const LLVMBuilderContext::ScopedObject* owned = nullptr;
+            if (auto extract = utils::cast<ir::ValueExtract>(args.at(0).get()))
+              if (auto variable = utils::dyn_cast<ir::Variable>(extract->getValue())) owned = getOwnedObject(variable->getId());
+            if (owned) destroyObject(*owned);
             builder->CreateStore(right, left);
+            if (owned) builder->CreateStore(builder->getTrue(), owned->alive);
             //}
             break;
           }
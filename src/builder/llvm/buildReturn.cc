@@ -52,13 +52,16 @@ void LLVMBuilder::visit(ir::Return* ret) {
       }
       // auto store = builder->CreateStore(load(e, ret->getType()), retArg);
 
+      destroyScopes(0);
       builder->CreateRetVoid();
       return;
     }
 
     auto e = expr(exprValue.get());
+    destroyScopes(0);
     val = builder->CreateRet(e);
   } else {
+    destroyScopes(0);
     val = builder->CreateRetVoid();
   }
 
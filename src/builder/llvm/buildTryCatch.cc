@@ -5,6 +5,7 @@
 
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
+#include <set>
 
 #include "../../../runtime/libs/exceptions.h"
 
@@ -49,14 +50,9 @@ void LLVMBuilder::visit(ir::TryCatch* node) {
   auto catchVars = node->getCatchVars();
   assert(catchInstances.size() == catchVars.size());
 
-  // MARK: try block
-  builder->SetInsertPoint(tryBlock);
-  tryCatchStack.push_back(std::move(info));
-  build(node->getBlock().get());
-  tryCatchStack.pop_back();
-
+  // The handlers are known before building the try block so that nested
+  // try blocks can also catch the exceptions handled here (see below).
   for (int i = 0; i < (int)catchInstances.size(); i++) {
-    auto catchBlock = catchInstances[i];
     auto catchVar = catchVars[i];
     auto catchBlockBB = llvm::BasicBlock::Create(*context, "catch.block", parentFunc);
 
@@ -64,6 +60,13 @@ void LLVMBuilder::visit(ir::TryCatch* node) {
     info.catchVars.push_back(catchVar);
   }
 
+  // MARK: try block
+  builder->SetInsertPoint(tryBlock);
+  tryCatchStack.push_back(std::move(info));
+  build(node->getBlock().get());
+  info = std::move(tryCatchStack.back());
+  tryCatchStack.pop_back();
+
   builder->CreateBr(endBlock);
 
   // MARK: unwind resume block
@@ -77,7 +80,16 @@ void LLVMBuilder::visit(ir::TryCatch* node) {
   auto caughtException = builder->CreateLandingPad(padType, catchInstances.size());
   caughtException->setCleanup(true);
 
-  for (auto catchVar : info.catchVars) {
+  // The exceptions caught by the enclosing try blocks of this function are
+  // also listed, otherwise the search phase would skip this frame for them.
+  // They are routed to the enclosing catch block (see the default route).
+  auto handledVars = info.catchVars;
+  for (auto& enclosing : tryCatchStack)
+    handledVars.insert(handledVars.end(), enclosing.catchVars.begin(), enclosing.catchVars.end());
+
+  std::set<std::string> addedClauses;
+  for (auto catchVar : handledVars) {
+    if (!addedClauses.insert(catchVar->getType()->getMangledName()).second) continue;
     auto varName = "snowball.typeidx." + catchVar->getType()->getMangledName();
     llvm::GlobalVariable* tidx = module->getGlobalVariable(varName);
     if (!tidx) {
@@ -99,6 +111,9 @@ void LLVMBuilder::visit(ir::TryCatch* node) {
   auto unwindException = builder->CreateExtractValue(caughtException, 0);
   builder->CreateStore(caughtException, info.exceptionPad);
 
+  // Destroy the objects that were alive inside the try block when the exception got thrown.
+  for (auto object = info.objects.rbegin(); object != info.objects.rend(); ++object) destroyObject(*object);
+
   builder->CreateStore(caughtResultStorage, caughtResultStorage);
   builder->CreateStore(unwindException, exceptionStorage);
   builder->CreateStore(ourExceptionThrownState, exceptionCaughtFlag);
@@ -135,9 +150,21 @@ void LLVMBuilder::visit(ir::TryCatch* node) {
   objType = builder->CreateExtractValue(objType, 0);
   auto objPtr = builder->CreateExtractValue(loadedExc, 1);
 
+  // Exceptions that aren't handled here keep unwinding: into the enclosing
+  // try block or the function's cleanup pad if there is one, out of the
+  // function otherwise. A landing pad can't be branched to, so the exception
+  // is raised again with an invoke to it.
   auto defaultRouteBlock = llvm::BasicBlock::Create(*context, "trycatch.fdepth", parentFunc);
   builder->SetInsertPoint(defaultRouteBlock);
-  builder->CreateBr(endBlock);
+  if (tryCatchStack.empty() && !ctx->cleanupBlock) {
+    builder->CreateBr(unwindResumeBlock);
+  } else {
+    auto resumeType = llvm::FunctionType::get(builder->getVoidTy(), {builder->getInt8PtrTy()}, false);
+    auto resumeFn = module->getOrInsertFunction("_Unwind_Resume", resumeType);
+    auto exception = builder->CreateExtractValue(builder->CreateLoad(padType, info.exceptionPad), 0);
+    createCall(resumeType, resumeFn.getCallee(), {exception});
+    builder->CreateUnreachable();
+  }
 
   builder->SetInsertPoint(info.catchRouteBlock);
   auto castSwitch = builder->CreateSwitch(objType, defaultRouteBlock, (unsigned) catchInstances.size());
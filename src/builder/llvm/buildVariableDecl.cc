@@ -64,6 +64,8 @@ void LLVMBuilder::visit(ir::VariableDeclaration* variable) {
     auto generatedValue = expr(variable->getValue().get());
     builder->CreateStore(generatedValue, store);
   }
+
+  addScopedObject(variable, store);
 }
 
 } // namespace codegen
@@ -19,6 +19,7 @@ void LLVMBuilder::visit(ir::WhileLoop* c) {
   ctx->loop = {
     .continueBlock = condBB,
     .breakBlock = continueBB,
+    .scopeDepth = ctx->scopes.size(),
   };
 
   if (c->isDoWhile()) {
@@ -10,11 +10,13 @@ namespace snowball {
 namespace codegen {
 
 llvm::Value* LLVMBuilder::createCall(llvm::FunctionType* ty, llvm::Value* callee, llvm::ArrayRef<llvm::Value*> args) {
-  if (tryCatchStack.empty()) {
+  if (tryCatchStack.empty() && !ctx->cleanupBlock) {
     return builder->CreateCall(ty, callee, args);
   } else {
+    // Outside of a try block, exceptions unwind through the cleanup pad
+    // so the objects owned by this function still get destroyed.
     auto normalBlock = llvm::BasicBlock::Create(*context, "invoke.normal", ctx->getCurrentFunction());
-    auto unwindBlock = tryCatchStack.back().catchBlock;
+    auto unwindBlock = tryCatchStack.empty() ? ctx->cleanupBlock : tryCatchStack.back().catchBlock;
     auto result = builder->CreateInvoke(ty, callee, normalBlock, unwindBlock, args);
     builder->SetInsertPoint(normalBlock);
     return result;
@@ -21,12 +21,9 @@ void LLVMBuilder::createBenchmark(llvm::Function* mainFunction) {
   builder->CreateCall(
           printFunction,
           {builder->CreateGlobalStringPtr(
-                  FMT("\nExecuting %s%i%s benchmark(s)... \n %snote:%s this can take a while! "
-                      "you wont see any output until benchmarks are done.\n",
+                  FMT("\nExecuting %s%i%s benchmark(s)... \n",
                       BBLU,
                       ctx->benchmarks.size(),
-                      RESET,
-                      BOLD,
                       RESET),
                   "bench.msg"
           )}
@@ -41,7 +38,10 @@ void LLVMBuilder::createBenchmark(llvm::Function* mainFunction) {
     return;
   }
 
-  auto benchFunc = module->getFunction("sn.bench.run"); // Always match this
+  auto benchType = llvm::FunctionType::get(
+          builder->getInt32Ty(), {builder->getInt8PtrTy(), builder->getInt8PtrTy(), builder->getInt32Ty()}, false
+  );
+  auto benchFunc = module->getOrInsertFunction(getSharedLibraryName("sn.runtime.bench.run"), benchType);
   auto llvmBenchmarks = std::vector<llvm::Constant*>();
   auto benchmarkNames = std::vector<llvm::Constant*>();
   for (auto [fn, llvmFunc] : ctx->benchmarks) {
@@ -63,9 +63,11 @@ void LLVMBuilder::createBenchmark(llvm::Function* mainFunction) {
           *module, nameArray->getType(), true, llvm::GlobalValue::PrivateLinkage, nameArray, "bench.name.array"
   );
 
-  builder->CreateCall(benchFunc, {arrayGlobal, globalNameArray, builder->getInt32(llvmBenchmarks.size())});
-  // TODO: dynamic if tests fail
-  builder->CreateRet(builder->getInt32(0));
+  // The runtime returns the number of benchmarks that regressed
+  // compared to the baseline (if any).
+  auto regressions =
+          builder->CreateCall(benchFunc, {arrayGlobal, globalNameArray, builder->getInt32(llvmBenchmarks.size())});
+  builder->CreateRet(builder->CreateZExt(builder->CreateICmpNE(regressions, builder->getInt32(0)), builder->getInt32Ty()));
 
   std::string module_error_string;
   llvm::raw_string_ostream module_error_stream(module_error_string);
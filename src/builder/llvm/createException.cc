@@ -10,7 +10,9 @@ namespace snowball {
 namespace codegen {
 
 llvm::Value* LLVMBuilder::createException(llvm::Value* value, types::Type* type) {
-  auto ty = llvm::FunctionType::get(builder->getInt8PtrTy(), {builder->getInt8PtrTy(), builder->getInt32Ty()}, false);
+  auto ty = llvm::FunctionType::get(
+          builder->getInt8PtrTy(), {builder->getInt8PtrTy(), builder->getInt32Ty(), builder->getInt8PtrTy()}, false
+  );
   auto f =
           llvm::cast<llvm::Function>(module->getOrInsertFunction(getSharedLibraryName("sn.eh.create"), ty).getCallee());
   f->addRetAttr(llvm::Attribute::NonNull);
@@ -22,7 +24,8 @@ llvm::Value* LLVMBuilder::createException(llvm::Value* value, types::Type* type)
   int typeId = typeIdxLookup(type->getMangledName());
   auto cast = builder->CreatePointerCast(usedValue, builder->getInt8PtrTy());
 
-  return builder->CreateCall(f, {cast, builder->getInt32(typeId)});
+  auto name = builder->CreateGlobalStringPtr(type->getPrettyName(), ".eh.name");
+  return builder->CreateCall(f, {cast, builder->getInt32(typeId), name});
 }
 
 } // namespace codegen
@@ -39,8 +39,10 @@ llvm::Function* LLVMBuilder::createLLVMFunction(ir::Func* func) {
   auto name = func->getMangle();
   auto fn = llvm::Function::Create(
           fnType,
-          ((func->isStatic() && (!func->hasParent())) ||
-           (func->hasAttribute(Attributes::INTERNAL_LINKAGE) && !func->isDeclaration())) ?
+          // Every function can be referenced from another unit if we are
+          // only generating a part of the program.
+          (!codegenUnit && ((func->isStatic() && (!func->hasParent())) ||
+                            (func->hasAttribute(Attributes::INTERNAL_LINKAGE) && !func->isDeclaration()))) ?
                   llvm::Function::InternalLinkage :
                   llvm::Function::ExternalLinkage,
           name,
@@ -38,7 +38,12 @@ llvm::GlobalVariable* LLVMBuilder::createVirtualTable(types::BaseType* ty, llvm:
 
   module->getOrInsertGlobal(structName, vtableType);
   auto vTable = module->getNamedGlobal(structName);
-  vTable->setLinkage(llvm::GlobalValue::LinkageTypes::InternalLinkage);
+  // Each unit that needs a vtable generates its own copy, the linker
+  // will then keep just one of them.
+  vTable->setLinkage(
+          codegenUnit ? llvm::GlobalValue::LinkageTypes::LinkOnceODRLinkage :
+                        llvm::GlobalValue::LinkageTypes::InternalLinkage
+  );
   vTable->setConstant(true);
   vTable->setDSOLocal(true);
   vTable->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
@@ -53,8 +58,24 @@ llvm::GlobalVariable* LLVMBuilder::createVirtualTable(types::BaseType* ty, llvm:
   );
   auto s = llvm::ConstantStruct::get(vtableType, arr);
   vTable->setInitializer(s);
+
+  if (hasWholeProgramVtables()) {
+    // A virtual call can be made through any of the classes it inherits from
+    // since their vtables are a prefix of this one. All of them point to
+    // the start of the vtable, the slots are accessed with offsets from it.
+    for (auto parent = utils::cast<types::DefinedType>(ty); parent; parent = parent->getParent()) {
+      vTable->addTypeMetadata(0, getVtableTypeId(parent));
+    }
+
+    vTable->setVCallVisibilityMetadata(llvm::GlobalObject::VCallVisibilityTranslationUnit);
+  }
+
   return vTable;
 }
 
+llvm::MDString* LLVMBuilder::getVtableTypeId(types::BaseType* ty) {
+  return llvm::MDString::get(*context, (std::string) _SN_VTABLE_PREFIX + ty->getMangledName());
+}
+
 } // namespace codegen
 } // namespace snowball
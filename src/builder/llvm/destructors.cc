@@ -0,0 +1,86 @@
+
+#include "../../ir/values/VariableDeclaration.h"
+#include "../../utils/utils.h"
+#include "LLVMBuilder.h"
+
+#include <llvm/IR/Type.h>
+#include <llvm/IR/Value.h>
+
+namespace snowball {
+namespace codegen {
+
+void LLVMBuilder::addScopedObject(ir::VariableDeclaration* variable, llvm::Value* storage) {
+  if (!variable->getVariable()->needsDrop() || ctx->scopes.empty()) return;
+  auto type = utils::cast<types::BaseType>(variable->getType());
+  if (!type) return;
+  auto destructor = destructors.find(type->getId());
+  if (destructor == destructors.end()) return;
+
+  // The flag starts cleared at the function's entry, so exits reached before
+  // the declaration (or after the object got destroyed) don't destroy anything.
+  auto alive = createAlloca(builder->getInt1Ty(), ".alive." + variable->getIdentifier());
+  auto backupBlock = builder->GetInsertBlock();
+  if (auto entryTerminator = ctx->getCurrentFunction()->getEntryBlock().getTerminator()) {
+    builder->SetInsertPoint(entryTerminator);
+    builder->CreateStore(builder->getFalse(), alive);
+    builder->SetInsertPoint(backupBlock);
+  }
+  builder->CreateStore(builder->getTrue(), alive);
+
+  LLVMBuilderContext::ScopedObject object{.storage = storage, .alive = alive, .destructor = destructor->second};
+  ctx->scopes.back().push_back(object);
+  ctx->ownedObjects.emplace_back(variable->getVariable()->getId(), object);
+  if (!tryCatchStack.empty()) tryCatchStack.back().objects.push_back(object);
+  // Calls made outside of a try block unwind into this pad from now on (see createCall).
+  if (!ctx->cleanupBlock) ctx->cleanupBlock = llvm::BasicBlock::Create(*context, "cleanup", ctx->getCurrentFunction());
+}
+
+const LLVMBuilderContext::ScopedObject* LLVMBuilder::getOwnedObject(ir::id_t variable) {
+  for (auto& [id, object] : ctx->ownedObjects)
+    if (id == variable) return &object;
+  return nullptr;
+}
+
+void LLVMBuilder::buildCleanupPad() {
+  if (!ctx->cleanupBlock) return;
+  builder->SetInsertPoint(ctx->cleanupBlock);
+  auto padType = llvm::StructType::get(builder->getInt8PtrTy(), builder->getInt32Ty());
+  auto pad = builder->CreateLandingPad(padType, 0);
+  pad->setCleanup(true);
+  // The alive flags tell which objects were already constructed (and not yet
+  // destroyed) at the point the exception got thrown.
+  for (auto owned = ctx->ownedObjects.rbegin(); owned != ctx->ownedObjects.rend(); ++owned) destroyObject(owned->second);
+  builder->CreateResume(pad);
+  ctx->cleanupBlock = nullptr;
+  ctx->ownedObjects.clear();
+}
+
+void LLVMBuilder::destroyScopes(size_t depth) {
+  for (size_t i = ctx->scopes.size(); i > depth; --i) {
+    auto& scope = ctx->scopes.at(i - 1);
+    for (auto object = scope.rbegin(); object != scope.rend(); ++object) destroyObject(*object);
+  }
+}
+
+void LLVMBuilder::destroyObject(const LLVMBuilderContext::ScopedObject& object) {
+  auto parent = ctx->getCurrentFunction();
+  auto destroyBB = llvm::BasicBlock::Create(*context, "destroy", parent);
+  auto continueBB = llvm::BasicBlock::Create(*context, "destroy.end", parent);
+
+  auto alive = builder->CreateLoad(builder->getInt1Ty(), object.alive);
+  builder->CreateCondBr(alive, destroyBB, continueBB);
+
+  builder->SetInsertPoint(destroyBB);
+  builder->CreateStore(builder->getFalse(), object.alive);
+  // note: A plain call is used even inside try blocks, destructors are
+  //  also called while unwinding and they can't unwind into themselves.
+  auto destructor = llvm::cast<llvm::Function>(build(object.destructor));
+  auto call = builder->CreateCall(destructor, {object.storage});
+  if (auto subprogram = parent->getSubprogram()) call->setDebugLoc(llvm::DILocation::get(*context, 0, 0, subprogram));
+  builder->CreateBr(continueBB);
+
+  builder->SetInsertPoint(continueBB);
+}
+
+} // namespace codegen
+} // namespace snowball
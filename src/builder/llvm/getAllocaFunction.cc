@@ -11,8 +11,10 @@ namespace snowball {
 namespace codegen {
 
 llvm::Function* LLVMBuilder::getAllocaFunction() {
-  auto ty = llvm::FunctionType::get(builder->getInt8PtrTy(), {builder->getInt32Ty()}, false);
-  auto f = llvm::cast<llvm::Function>(module->getOrInsertFunction("malloc", ty).getCallee());
+  // Memory is taken from the arena entered by the current thread (if any),
+  // otherwise it's garbage collected. See runtime/libs/arena.cc
+  auto ty = llvm::FunctionType::get(builder->getInt8PtrTy(), {builder->getInt64Ty()}, false);
+  auto f = llvm::cast<llvm::Function>(module->getOrInsertFunction("sn.runtime.arena.alloc", ty).getCallee());
   f->addRetAttr(llvm::Attribute::NonNull);
   f->addRetAttr(llvm::Attribute::NoAlias);
   f->addRetAttr(llvm::Attribute::NoUndef);
@@ -0,0 +1,115 @@
+#include "../../../errors.h"
+#include "../../../utils/utils.h"
+#include "../LLVMBuilder.h"
+
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/DynamicLibrary.h>
+#include <llvm/Support/Error.h>
+
+#include <string.h>
+
+namespace snowball {
+namespace codegen {
+
+namespace {
+template <typename T>
+T unwrapOrThrow(llvm::Expected<T> value, const std::string& message) {
+  if (!value) throw SNError(Error::LLVM_INTERNAL, FMT("%s: %s", message.c_str(), llvm::toString(value.takeError()).c_str()));
+  return std::move(*value);
+}
+
+void throwIfError(llvm::Error err, const std::string& message) {
+  if (err) throw SNError(Error::LLVM_INTERNAL, FMT("%s: %s", message.c_str(), llvm::toString(std::move(err)).c_str()));
+}
+
+/**
+ * Memory manager that registers the writable data sections of the JIT'd code
+ * as roots of the runtime's garbage collector. They are not part of any
+ * loaded object, so the collector wouldn't find the globals stored in them.
+ */
+class GCRootsMemoryManager : public llvm::SectionMemoryManager {
+  using AddRoots = void (*)(const void*, uint64_t);
+  using RemoveRoots = void (*)(const void*);
+
+  // Looked up like the program's symbols, so that we use the same runtime
+  AddRoots addRoots = (AddRoots) llvm::sys::DynamicLibrary::SearchForAddressOfSymbol("sn.gc.add_roots");
+  RemoveRoots removeRoots = (RemoveRoots) llvm::sys::DynamicLibrary::SearchForAddressOfSymbol("sn.gc.remove_roots");
+  std::vector<uint8_t*> roots;
+
+public:
+  uint8_t* allocateDataSection(
+          uintptr_t size, unsigned alignment, unsigned sectionID, llvm::StringRef sectionName, bool isReadOnly
+  ) override {
+    auto section = SectionMemoryManager::allocateDataSection(size, alignment, sectionID, sectionName, isReadOnly);
+    if (section && !isReadOnly && addRoots && removeRoots) {
+      addRoots(section, size);
+      roots.push_back(section);
+    }
+
+    return section;
+  }
+
+  ~GCRootsMemoryManager() override {
+    for (auto root : roots) removeRoots(root);
+  }
+};
+} // namespace
+
+int LLVMBuilder::executeJIT(std::vector<std::string> args, std::vector<std::string> libraries) {
+  // Libraries are loaded into the compiler's process so that the JIT can
+  // resolve the symbols the program uses from them (e.g. "sn.runtime.*").
+  for (auto& library : libraries) {
+    std::string error;
+    if (llvm::sys::DynamicLibrary::LoadLibraryPermanently(library.c_str(), &error)) {
+      throw SNError(Error::LINKER_ERR, FMT("Could not load library '%s' for the JIT: %s", library.c_str(), error.c_str()));
+    }
+  }
+
+  auto jit = unwrapOrThrow(
+          llvm::orc::LLJITBuilder()
+                  .setObjectLinkingLayerCreator([](llvm::orc::ExecutionSession& session, const llvm::Triple&) {
+                    return std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(
+                            session, [] { return std::make_unique<GCRootsMemoryManager>(); }
+                    );
+                  })
+                  .create(),
+          "Could not create the JIT"
+  );
+  auto& mainDylib = jit->getMainJITDylib();
+  mainDylib.addGenerator(unwrapOrThrow(
+          llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(jit->getDataLayout().getGlobalPrefix()),
+          "Could not search for symbols in the current process"
+  ));
+
+  DEBUG_CODEGEN("Adding module to the JIT...");
+  module->setDataLayout(jit->getDataLayout());
+  throwIfError(
+          jit->addIRModule(llvm::orc::ThreadSafeModule(std::move(module), std::move(context))),
+          "Could not add the module to the JIT"
+  );
+  // Runs the global constructors (e.g. the runtime initialization)
+  throwIfError(jit->initialize(mainDylib), "Could not initialize the JIT");
+
+  auto mainAddr = unwrapOrThrow(jit->lookup("main"), "Could not find the program's entry point");
+  auto main = mainAddr.toPtr<int (*)(int, char**)>();
+
+  std::vector<char*> argv;
+  for (auto& arg : args) argv.push_back(strdup(arg.c_str()));
+  argv.push_back(nullptr);
+
+  DEBUG_CODEGEN("Executing program with the JIT...");
+  int result = main(argv.size() - 1, argv.data());
+  throwIfError(jit->deinitialize(mainDylib), "Could not deinitialize the JIT");
+
+  for (auto arg : argv) free(arg);
+  return result;
+}
+
+} // namespace codegen
+} // namespace snowball
@@ -1,5 +1,6 @@
 
 #include "../../../common.h"
+#include "../../../errors.h"
 #include "../../../utils/utils.h"
 #include "../LLVMBuilder.h"
 
@@ -17,8 +18,9 @@
 #include <llvm/IR/InlineAsm.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/IR/LLVMContext.h>
-#include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Module.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/IR/PassTimingInfo.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Value.h>
 #include <llvm/IR/Verifier.h>
@@ -28,12 +30,13 @@
 #include <llvm/Support/FileSystem.h>
 #include <llvm/Support/FormattedStream.h>
 #include <llvm/Support/Host.h>
+#include <llvm/Support/TimeProfiler.h>
 #include <llvm/Transforms/IPO.h>
-#include <llvm/Transforms/InstCombine/InstCombine.h>
-#include <llvm/Transforms/Scalar.h>
-#include <llvm/Transforms/Scalar/GVN.h>
-#include <llvm/Transforms/Scalar/Reassociate.h>
-#include <llvm/Transforms/Utils.h>
+#include <llvm/Transforms/IPO/LowerTypeTests.h>
+#include <llvm/Transforms/IPO/WholeProgramDevirt.h>
+
+#include <mutex>
+#include <optional>
 
 namespace snowball {
 
@@ -58,24 +61,49 @@ void applyDebugTransformations(llvm::Module* module, bool debug) {
 }
 } // namespace
 
-#ifndef PERFORM_SIMPLE_OPTS
-#define PERFORM_SIMPLE_OPTS 1
-#endif
-
 namespace codegen {
 
 void LLVMBuilder::optimizeModule() {
+  llvm::TimeTraceScope timeScope("Optimize", module->getName());
 
   llvm::LoopAnalysisManager loop_analysis_manager;
   llvm::FunctionAnalysisManager function_analysis_manager;
   llvm::CGSCCAnalysisManager c_gscc_analysis_manager;
   llvm::ModuleAnalysisManager module_analysis_manager;
 
-  // Create the new pass manager builder.
-  // Take a look at the PassBuilder constructor parameters for more
-  // customization, e.g. specifying a TargetMachine or various
-  // debugging options.
-  llvm::PassBuilder pass_builder;
+  // Record every pass that runs when `--time-trace` is enabled.
+  llvm::PassInstrumentationCallbacks instrumentation;
+  if (llvm::timeTraceProfilerEnabled()) {
+    auto moduleName = module->getName().str();
+    instrumentation.registerBeforeNonSkippedPassCallback([moduleName](llvm::StringRef pass, llvm::Any) {
+      llvm::timeTraceProfilerBegin(pass, moduleName);
+    });
+    instrumentation.registerAfterPassCallback([](llvm::StringRef, llvm::Any, const llvm::PreservedAnalyses&) {
+      llvm::timeTraceProfilerEnd();
+    });
+    instrumentation.registerAfterPassInvalidatedCallback([](llvm::StringRef, const llvm::PreservedAnalyses&) {
+      llvm::timeTraceProfilerEnd();
+    });
+  }
+
+  // Report how long every pass took when `-time-passes` is given.
+  llvm::TimePassesHandler timePasses(llvm::TimePassesIsEnabled);
+  timePasses.registerCallbacks(instrumentation);
+
+  // Create the new pass manager builder. The target machine gives the
+  // optimizations (e.g. the vectorizers) the cost model of the CPU that
+  // the module is compiled for.
+  //
+  // Profile instrumentation is added (or the profile read) early on the pipeline, before inlining.
+  std::optional<llvm::PGOOptions> pgo;
+  using PGO = llvm::PGOOptions;
+  switch (profileMode) {
+    case app::Options::ProfileOptions::GENERATE: pgo = PGO(profileFile, "", "", PGO::IRInstr); break;
+    case app::Options::ProfileOptions::USE: pgo = PGO(profileFile, "", "", PGO::IRUse); break;
+    default: break;
+  }
+
+  llvm::PassBuilder pass_builder(target, llvm::PipelineTuningOptions(), pgo, &instrumentation);
 
   // Register all the basic analyses with the managers.
   pass_builder.registerModuleAnalyses(module_analysis_manager);
@@ -107,43 +135,43 @@ void LLVMBuilder::optimizeModule() {
   PipelineStartEPCallbacks.push_back([](llvm::ModulePassManager& MPM, llvm::OptimizationLevel Level) {
     MPM.addPass(llvm::VerifierPass());
   });
+  if (hasWholeProgramVtables()) {
+    // Devirtualize before anything gets inlined, so that the calls
+    // that got resolved can be inlined too. The type tests are only
+    // hints for it, they are removed right after.
+    PipelineStartEPCallbacks.push_back([](llvm::ModulePassManager& MPM, llvm::OptimizationLevel Level) {
+      MPM.addPass(llvm::WholeProgramDevirtPass(nullptr, nullptr));
+      MPM.addPass(llvm::LowerTypeTestsPass(nullptr, nullptr, /* DropTypeTests = */ true));
+    });
+  }
   for (const auto& C : PipelineStartEPCallbacks) pass_builder.registerPipelineStartEPCallback(C);
   for (const auto& C : OptimizerLastEPCallbacks) pass_builder.registerOptimizerLastEPCallback(C);
   llvm::ModulePassManager mpm;
-  if (dbg.debug) {
-    mpm = pass_builder.buildThinLTODefaultPipeline(level, nullptr);
-  } else {
-#if PERFORM_SIMPLE_OPTS
-  { // simple optimizations done for each function. It does not depend on the optimization level.
-    std::unique_ptr<llvm::legacy::FunctionPassManager> functionPassManager =
-            std::make_unique<llvm::legacy::FunctionPassManager>(module.get());
-
-    // Promote allocas to registers.
-    functionPassManager->add(llvm::createPromoteMemoryToRegisterPass());
-    // Do simple "peephole" optimizations
-    functionPassManager->add(llvm::createInstructionCombiningPass());
-    // Reassociate expressions.
-    functionPassManager->add(llvm::createReassociatePass());
-    // Eliminate Common SubExpressions.
-    functionPassManager->add(llvm::createGVNPass());
-    // Simplify the control flow graph (deleting unreachable blocks etc).
-    functionPassManager->add(llvm::createCFGSimplificationPass());
-
-    functionPassManager->doInitialization();
-
-    for (auto& function : module->getFunctionList()) { functionPassManager->run(function); }
-  }
-
-  llvm::legacy::PassManager codegen_pm;
-  codegen_pm.add(llvm::createTargetTransformInfoWrapperPass(target->getTargetIRAnalysis()));
+  if (!passPipeline.empty()) {
+    if (auto err = pass_builder.parsePassPipeline(mpm, passPipeline)) {
+      throw SNError(
+              Error::ARGUMENT_ERROR,
+              FMT("Invalid pass pipeline '%s': %s", passPipeline.c_str(), llvm::toString(std::move(err)).c_str())
+      );
+    }
 
-  codegen_pm.run(*module);
-#endif
-  
-    mpm = pass_builder.buildLTOPreLinkDefaultPipeline(level);
+    // Code generation can't handle type tests, a custom pipeline may not drop them
+    if (hasWholeProgramVtables()) mpm.addPass(llvm::LowerTypeTestsPass(nullptr, nullptr, /* DropTypeTests = */ true));
+  } else if (level == llvm::OptimizationLevel::O0) {
+    mpm = pass_builder.buildO0DefaultPipeline(level);
+  } else {
+    // Modules are linked as object files, no (LTO) optimization happens after this.
+    // Whole program builds already contain every function inside of this module.
+    mpm = pass_builder.buildPerModuleDefaultPipeline(level);
   }
 
   mpm.run(*module, module_analysis_manager);
+  if (llvm::TimePassesIsEnabled) {
+    // Modules may be optimized concurrently, print their reports one at a time
+    static std::mutex reportMutex;
+    std::lock_guard<std::mutex> lock(reportMutex);
+    timePasses.print();
+  }
 
   applyDebugTransformations(module.get(), dbg.debug);
 }
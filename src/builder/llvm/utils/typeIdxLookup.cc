@@ -1,20 +1,16 @@
+#include "../../../utils/utils.h"
 #include "../LLVMBuilder.h"
 
+#include <cstdint>
+
 namespace snowball {
 namespace codegen {
 namespace llvm_utils {
 int typeIdxLookup(const std::string& name) {
-  static std::unordered_map<std::string, int> cache;
-  static int next = 1000;
   if (name.empty()) return 0;
-  auto it = cache.find(name);
-  if (it != cache.end()) {
-    return it->second;
-  } else {
-    const int myID = next++;
-    cache[name] = myID;
-    return myID;
-  }
+  // It only depends on the name, so that every codegen unit (and every
+  // build, since cached objects are reused) agrees on the id of a type.
+  return 1000 + (int) (utils::hashString(name) % (INT32_MAX - 1000));
 }
 } // namespace llvm_utils
 } // namespace codegen
@@ -1,5 +1,8 @@
 #include "compiler.h"
 
+#include "ast/types/FunctionType.h"
+#include "ast/types/PointerType.h"
+#include "ast/types/ReferenceType.h"
 #include "builder/linker/Linker.h"
 #include "builder/llvm/LLVMBuilder.h"
 #include "builder/sn-ir/SnowballIREmitter.h"
@@ -8,15 +11,25 @@
 #include "lexer/lexer.h"
 #include "parser/Parser.h"
 #include "pm/Manager.h"
+#include "services/ObjectCache.h"
+#include "services/ProfileService.h"
+#include "utils/parallel.h"
 #include "utils/utils.h"
 #include "visitors/Analyzer.h"
+#include "visitors/EscapeAnalysis.h"
 #include "visitors/Transformer.h"
 #include "visitors/TypeChecker.h"
 #include "visitors/analyzers/DefinitveAssigment.h"
 #include "visitors/documentation/DocGen.h"
 
+#include <llvm/IR/PassTimingInfo.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/TimeProfiler.h>
+
 #include <filesystem>
 #include <fstream>
+#include <mutex>
+#include <optional>
 #include <regex>
 #include <stdio.h>
 #include <string>
@@ -25,6 +38,58 @@
 namespace fs = std::filesystem;
 
 namespace snowball {
+namespace {
+// Source files of the modules defining a type and the types it's made of.
+void collectTypeSources(types::Type* type, std::set<fs::path>& sources, std::set<types::Type*>& visited) {
+  if (!type || !visited.insert(type).second) return;
+  if (auto x = utils::cast<types::PointerType>(type)) return collectTypeSources(x->getPointedType(), sources, visited);
+  if (auto x = utils::cast<types::ReferenceType>(type)) return collectTypeSources(x->getPointedType(), sources, visited);
+  if (auto x = utils::cast<types::FunctionType>(type)) {
+    for (auto arg : x->getArgs()) collectTypeSources(arg, sources, visited);
+    return collectTypeSources(x->getRetType(), sources, visited);
+  }
+  if (auto x = utils::cast<types::BaseType>(type)) {
+    if (auto m = x->getModule()) sources.insert(m->getSourceInfo()->getPath());
+    for (auto g : x->getGenerics()) collectTypeSources(g, sources, visited);
+    if (auto d = utils::cast<types::DefinedType>(x); d && d->hasParent())
+      collectTypeSources(d->getParent(), sources, visited);
+  }
+}
+
+/**
+ * @return A hash of everything the code of a unit is generated from: the
+ *  functions and variables it defines, its source file (and its imports)
+ *  and the source files of every type used by its functions. Generic
+ *  instances live in the unit that declares the generic, but their code
+ *  depends on the types they got created with, which the unit doesn't
+ *  need to import.
+ *  Nothing is returned if any of those can't be traced back to a source
+ *  file of the import graph.
+ */
+std::optional<uint64_t> getUnitSourceHash(services::ObjectCache* cache, std::shared_ptr<ir::Module> unit, const fs::path& cwd) {
+  std::set<fs::path> sources = {unit->getSourceInfo()->getPath()};
+  std::set<types::Type*> visited;
+  std::string key;
+  for (auto& fn : unit->getFunctions()) {
+    key += fn->getMangle() + ";";
+    for (auto [_, g] : fn->getGenerics()) collectTypeSources(g, sources, visited);
+    if (fn->hasParent()) collectTypeSources(fn->getParent(), sources, visited);
+    for (auto [_, arg] : fn->getArgs()) collectTypeSources(arg->getType(), sources, visited);
+    collectTypeSources(fn->getRetTy(), sources, visited);
+  }
+  for (auto& var : unit->getVariables()) {
+    key += var->getIdentifier() + ";";
+    collectTypeSources(var->getType(), sources, visited);
+  }
+  for (auto& source : sources) {
+    auto hash = cache->getSourceHash(source.is_absolute() ? source : (cwd / source).lexically_normal());
+    if (!hash) return std::nullopt;
+    key += utils::hashToString(*hash) + ";";
+  }
+  return utils::hashString(key);
+}
+} // namespace
+
 Compiler::Compiler(std::string p_code, std::string p_path) {
   source = p_code;
   cwd = fs::current_path();
@@ -45,6 +110,7 @@ void Compiler::initialize() {
   if (!fs::exists(configFolder / "bin")) fs::create_directory(configFolder / "bin");
   if (!fs::exists(configFolder / "docs")) fs::create_directory(configFolder / "docs");
   if (!fs::exists(configFolder / "deps")) fs::create_directory(configFolder / "deps");
+  if (!fs::exists(configFolder / "cache")) fs::create_directory(configFolder / "cache");
 }
 
 void Compiler::compile(bool silent) {
@@ -62,59 +128,62 @@ void Compiler::compile(bool silent) {
 
   /* ignore_goto_errors() */ {
     SHOW_STATUS(Logger::compiling(Logger::progress(0.30)))
-    auto lexer = new Lexer(srcInfo);
-
-#if _SNOWBALL_TIMERS_DEBUG
-    DEBUG_TIMER("Lexer: %fs", utils::_timer([&] { lexer->tokenize(); }));
-#else
-    lexer->tokenize();
-#endif
-    auto tokens = lexer->tokens;
-    if (tokens.size() != 0) {
+    llvm::TimeTraceScope compileScope("Frontend", srcInfo->getPath());
+    auto mainModule = std::make_shared<ir::MainModule>();
+    mainModule->setSourceInfo(srcInfo);
+
+    auto simplifier = new Syntax::Transformer(
+            mainModule->downcasted_shared_from_this<ir::Module>(), srcInfo, ((fs::path) path).parent_path(), testsEnabled, benchmarkEnabled
+    );
+    auto& precompiled = simplifier->getImportService()->precompiled;
+    {
       SHOW_STATUS(Logger::compiling(Logger::progress(0.50)))
 
-      auto parser = new parser::Parser(tokens, srcInfo);
-#if _SNOWBALL_TIMERS_DEBUG
       parser::Parser::NodeVec ast;
-      DEBUG_TIMER("Parser: %fs", utils::_timer([&] { ast = parser->parse(); }));
+#if _SNOWBALL_TIMERS_DEBUG
+      DEBUG_TIMER("Parser: %fs", utils::_timer([&] { ast = precompiled->parse(srcInfo); }));
 #else
-      auto ast = parser->parse();
+      ast = precompiled->parse(srcInfo);
 #endif
 
       SHOW_STATUS(Logger::compiling(Logger::progress(0.55)))
-      auto mainModule = std::make_shared<ir::MainModule>();
-
-      mainModule->setSourceInfo(srcInfo);
-
-      auto simplifier = new Syntax::Transformer(
-              mainModule->downcasted_shared_from_this<ir::Module>(), srcInfo, ((fs::path) path).parent_path(), testsEnabled, benchmarkEnabled
-      );
       chdir(((fs::path) path).parent_path().c_str());
+      {
+        llvm::TimeTraceScope timeScope("Transformer", srcInfo->getPath());
 #if _SNOWBALL_TIMERS_DEBUG
-      DEBUG_TIMER("Simplifier: %fs", utils::_timer([&] { simplifier->visitGlobal(ast); }));
+        DEBUG_TIMER("Simplifier: %fs", utils::_timer([&] { simplifier->visitGlobal(ast); }));
 #else
-      simplifier->visitGlobal(ast);
+        simplifier->visitGlobal(ast);
 #endif
+      }
 
       SHOW_STATUS(Logger::compiling(Logger::progress(0.70)))
       std::vector<Syntax::Analyzer*> passes = {new Syntax::DefiniteAssigment(srcInfo)};
 
       mainModule->setModules(simplifier->getModules());
       module = mainModule;
+      for (auto& [file, imports] : simplifier->getDependencyGraph()) {
+        // The main file is the only one not resolved by the import service
+        dependencyGraph[file.is_absolute() ? file : (cwd / file).lexically_normal()] = imports;
+      }
 
+      {
+        llvm::TimeTraceScope timeScope("Analyzers");
 #if _SNOWBALL_TIMERS_DEBUG
-      DEBUG_TIMER("Passes: %fs", utils::_timer([&] {
-                    for (auto pass : passes) pass->run(ast);
-                  }));
+        DEBUG_TIMER("Passes: %fs", utils::_timer([&] {
+                      for (auto pass : passes) pass->run(ast);
+                    }));
 #else
-      for (auto pass : passes) { pass->run(ast); }
+        for (auto pass : passes) { pass->run(ast); }
 #endif
+      }
 
       SHOW_STATUS(Logger::compiling(Logger::progress(0.90)))
 
       auto typeCheckModules = mainModule->getModules();
       typeCheckModules.push_back(mainModule);
       for (auto module : typeCheckModules) {
+        llvm::TimeTraceScope timeScope("TypeChecker", module->getName());
         auto typeChecker = new codegen::TypeChecker(module);
 #if _SNOWBALL_TIMERS_DEBUG
         DEBUG_TIMER("TypeChecker: %fs (%s)", utils::_timer([&] { typeChecker->codegen(); }), module->getName().c_str());
@@ -123,6 +192,18 @@ void Compiler::compile(bool silent) {
 #endif
       }
 
+      // Needs every module to be type checked, since lambdas mark the
+      // variables they capture while being type checked.
+      for (auto module : typeCheckModules) {
+        llvm::TimeTraceScope timeScope("EscapeAnalysis", module->getName());
+        auto escapeAnalysis = new codegen::EscapeAnalysis(module);
+        escapeAnalysis->codegen();
+      }
+
+      // Every module has been parsed, so the tokens' text isn't needed
+      // anymore. Long lived processes (e.g. `-watch`) would keep growing it.
+      clearInternedStrings();
+
       SHOW_STATUS(Logger::compiling(Logger::progress(1)))
 
       SHOW_STATUS(Logger::reset_status())
@@ -140,12 +221,10 @@ void Compiler::runPackageManager(bool silent) {
   manager->runAsMain();
 }
 
-int Compiler::emitDocs(std::string folder, std::string baseURL, BasicPackageInfo package, bool silent) {
+int Compiler::emitDocs(std::string folder, std::string baseURL, BasicPackageInfo package, bool silent, unsigned jobs, bool force) {
   auto path = cwd / folder;
   auto outputFolder = configFolder / "docs";
-
-  fs::remove_all(outputFolder);
-  std::vector<std::string> modules;
+  auto manifestPath = outputFolder / "docs.json";
 
   if (utils::split(folder, "/").size() < 2) {
     auto parts = utils::list2vec(utils::split(folder, "/"));
@@ -156,6 +235,34 @@ int Compiler::emitDocs(std::string folder, std::string baseURL, BasicPackageInfo
     }
   }
 
+  // Pages of a file only depend on its contents, the templates and the options below.
+  // If any of the latter changed, everything is generated again.
+  auto version = utils::hashToString(utils::hashString(
+          std::string(_SNOWBALL_DOCS_TEMPLATE_VERSION) + "\n" + baseURL + "\n" + package.name + "\n" + package.version
+  ));
+  nlohmann::json previous;
+  if (!force && fs::exists(manifestPath)) {
+    std::ifstream ifs(manifestPath);
+    previous = nlohmann::json::parse(ifs, nullptr, false);
+    if (previous.is_discarded() || previous["version"] != version) previous = nlohmann::json();
+  }
+
+  if (previous.is_null()) fs::remove_all(outputFolder);
+
+  struct DocFile {
+    fs::path path;
+    std::string key;
+    std::string relative;
+    std::string modulePath;
+    std::string moduleName;
+    std::string content;
+    std::string hash;
+    std::vector<std::string> pages;
+  };
+
+  std::vector<std::string> modules;
+  std::vector<DocFile> files;
+  std::vector<size_t> outdated;
   for (const auto& dirEntry : recursive_directory_iterator(path)) {
     if (utils::endsWith(dirEntry.path().string(), ".sn")) {
       modules.push_back(fs::relative(dirEntry.path(), path).string());
@@ -178,42 +285,87 @@ int Compiler::emitDocs(std::string folder, std::string baseURL, BasicPackageInfo
       std::string moduleName = relativePath.string();
       utils::replaceAll(moduleName, "/", "::");
 
-      if (!silent)
-        Logger::message("Generating", " " + relative.string() + BCYN + " (" + relativePath.string() + ".html" + ")" + RESET);
-
       std::ifstream ifs(dirEntry.path().string());
       std::string content((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
 
-      srcInfo = new SourceInfo(content, dirEntry.path().string());
-      auto lexer = new Lexer(srcInfo);
-      lexer->tokenize();
-      auto tokens = lexer->tokens;
-      if (tokens.size() != 0) {
-        auto parser = new parser::Parser(tokens, srcInfo, true);
-        auto ast = parser->parse();
-        Syntax::DocGenContext context {
-          .currentModule = moduleName,
-          .currentModulePath = relativePath.string(),
-
-          .baseURL = baseURL,
-          .packageVersion = package.version,
-        };
-        auto docGen = new Syntax::DocGen(context);
-        docGen->run(ast);
-        auto result = docGen->getResult();
-
-        for (auto& page : result.pages) {
-          auto htmlPath = outputFolder / page.path;
-          if (!fs::exists(htmlPath.parent_path())) fs::create_directories(htmlPath.parent_path());
-
-          std::ofstream file(htmlPath);
-          file << page.html;
-          file.close();
+      DocFile file {
+        .path = dirEntry.path(),
+        .key = fs::relative(dirEntry.path(), path).string(),
+        .relative = relative.string(),
+        .modulePath = relativePath.string(),
+        .moduleName = moduleName,
+        .hash = utils::hashToString(utils::hashString(content)),
+      };
+      file.content = std::move(content);
+
+      auto cached = previous["files"][file.key];
+      if (!cached.is_null() && cached["hash"] == file.hash) {
+        file.pages = cached["pages"].get<std::vector<std::string>>();
+        file.content.clear();
+      } else {
+        // The file changed, pages it doesn't generate anymore must go away
+        if (!cached.is_null()) {
+          for (auto& page : cached["pages"]) fs::remove(outputFolder / page.get<std::string>());
         }
+        outdated.push_back(files.size());
       }
+
+      files.push_back(std::move(file));
+    }
+  }
+
+  // Remove the pages of files that got deleted
+  if (previous["files"].is_object()) {
+    for (auto& [key, cached] : previous["files"].items()) {
+      auto exists = std::any_of(files.begin(), files.end(), [&](auto& f) { return f.key == key; });
+      if (exists) continue;
+      for (auto& page : cached["pages"]) fs::remove(outputFolder / page.get<std::string>());
     }
   }
 
+  if (!silent && outdated.size() < files.size()) {
+    Logger::message("Skipping", FMT("%i unchanged module(s)", (int) (files.size() - outdated.size())));
+  }
+
+  std::mutex logMutex;
+  utils::parallelFor(outdated.size(), jobs, [&](size_t index) {
+    auto& file = files.at(outdated.at(index));
+    if (!silent) {
+      std::lock_guard<std::mutex> lock(logMutex);
+      Logger::message("Generating", " " + file.relative + BCYN + " (" + file.modulePath + ".html" + ")" + RESET);
+    }
+
+    auto source = new SourceInfo(file.content, file.path.string());
+    auto lexer = new Lexer(source);
+    lexer->tokenize();
+    auto tokens = std::move(lexer->tokens);
+    if (tokens.size() != 0) {
+      auto parser = new parser::Parser(std::move(tokens), source, true);
+      auto ast = parser->parse();
+      Syntax::DocGenContext context {
+        .currentModule = file.moduleName,
+        .currentModulePath = file.modulePath,
+
+        .baseURL = baseURL,
+        .packageVersion = package.version,
+      };
+      auto docGen = new Syntax::DocGen(context);
+      docGen->run(ast);
+      auto result = docGen->getResult();
+
+      for (auto& page : result.pages) {
+        auto htmlPath = outputFolder / page.path;
+        std::error_code ec; // Other workers may be creating the same folders
+        fs::create_directories(htmlPath.parent_path(), ec);
+
+        std::ofstream output(htmlPath);
+        output << page.html;
+        output.close();
+        file.pages.push_back(page.path.string());
+      }
+    }
+  });
+
   if (!silent) Logger::message("Indexing", (std::string)"module's paths into index book" + BCYN + " ("+package.name+".html)" + RESET);
   Syntax::DocGenContext context {
     .currentModule = package.name,
@@ -229,7 +381,11 @@ int Compiler::emitDocs(std::string folder, std::string baseURL, BasicPackageInfo
   std::ofstream file(htmlPath);
   file << page.html;
   file.close();
-    
+
+  nlohmann::json manifest = {{"version", version}, {"files", nlohmann::json::object()}};
+  for (auto& f : files) manifest["files"][f.key] = {{"hash", f.hash}, {"pages", f.pages}};
+  std::ofstream manifestFile(manifestPath);
+  manifestFile << manifest.dump(2);
   return EXIT_SUCCESS;
 }
 #undef SHOW_STATUS
@@ -249,22 +405,79 @@ toml::parse_result Compiler::getConfiguration() {
   );
 }
 
-void Compiler::cleanup() { }
+void Compiler::enableTimeTrace(std::string file) {
+  timeTraceFile = file.empty() ? configFolder / "time-trace.json" : fs::absolute(file);
+  llvm::timeTraceProfilerInitialize(_SNOWBALL_TIME_TRACE_GRANULARITY, "snowball");
+}
+
+void Compiler::cleanup() {
+  // Timings of the code generation passes (see `-time-passes`)
+  if (llvm::TimePassesIsEnabled) llvm::reportAndResetTimings();
+  if (timeTraceFile.empty() || !llvm::timeTraceProfilerEnabled()) return;
+  if (auto err = llvm::timeTraceProfilerWrite(timeTraceFile.string(), "snowball")) {
+    Logger::warning(FMT("Could not write the time trace: %s", llvm::toString(std::move(err)).c_str()));
+  } else {
+    DEBUG_CODEGEN("Time trace written to %s", timeTraceFile.c_str());
+  }
+  llvm::timeTraceProfilerCleanup();
+}
+
+void Compiler::setProfile(app::Options::ProfileOptions profile) {
+  using Mode = app::Options::ProfileOptions::Mode;
+  if (profile.mode != Mode::NONE && opt_level == app::Options::Optimization::OPTIMIZE_O0) {
+    // Profiles only match the code of optimized builds
+    Logger::warning("Profile guided optimization is ignored for unoptimized (-O0) builds");
+    profile.mode = Mode::NONE;
+  }
+
+  if (profile.mode != Mode::NONE) {
+    auto folder = profile.path.empty() ? configFolder / "profile" : fs::absolute(profile.path);
+    profile.path = folder.string();
+    if (profile.mode == Mode::GENERATE) {
+      std::error_code ec;
+      fs::create_directories(folder, ec);
+      profileFile = services::ProfileService::getRawProfilePath(folder);
+      profileHash = utils::hashString("generate:" + profileFile.string());
+    } else {
+      profileFile = services::ProfileService::getIndexedProfile(folder);
+      std::ifstream ifs(profileFile, std::ios::binary);
+      std::string content((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
+      profileHash = utils::hashString("use:" + content);
+    }
+  }
+
+  globalContext->profile = profile;
+}
+
+codegen::LLVMBuilder* Compiler::createBuilder(std::shared_ptr<ir::Module> unit) {
+  auto builder =
+          new codegen::LLVMBuilder(module, opt_level, testsEnabled, benchmarkEnabled, unit, globalContext->target);
+  if (globalContext->profile.mode != app::Options::ProfileOptions::NONE) {
+    builder->setProfile(globalContext->profile.mode, profileFile.string());
+  }
+  if (!globalContext->passPipeline.empty()) builder->setPassPipeline(globalContext->passPipeline);
+
+  return builder;
+}
 
 int Compiler::emitObject(std::string out, bool log) {
-  auto builder = new codegen::LLVMBuilder(module, opt_level, testsEnabled, benchmarkEnabled);
-  builder->codegen();
+  auto builder = createBuilder();
+  {
+    llvm::TimeTraceScope timeScope("Codegen", module->getName());
+    builder->codegen();
+  }
   builder->optimizeModule();
 
 #if _SNOWBALL_BYTECODE_DEBUG
   builder->dump();
 #endif
 
+  llvm::TimeTraceScope timeScope("EmitObject", out);
   return builder->emitObjectFile(out, log);
 }
 
 int Compiler::emitLLVMIr(std::string p_output, bool p_pmessage) {
-  auto builder = new codegen::LLVMBuilder(module, opt_level, testsEnabled, benchmarkEnabled);
+  auto builder = createBuilder();
   builder->codegen();
   builder->optimizeModule();
 
@@ -277,7 +490,7 @@ int Compiler::emitLLVMIr(std::string p_output, bool p_pmessage) {
 }
 
 int Compiler::emitASM(std::string p_output, bool p_pmessage) {
-  auto builder = new codegen::LLVMBuilder(module, opt_level, testsEnabled, benchmarkEnabled);
+  auto builder = createBuilder();
   builder->codegen();
   builder->optimizeModule();
 
@@ -286,24 +499,123 @@ int Compiler::emitASM(std::string p_output, bool p_pmessage) {
   return res;
 }
 
+std::vector<std::string> Compiler::emitObjects(std::string out) {
+  auto units = module->getModules();
+  units.push_back(module);
+
+  services::ObjectCache* cache = nullptr;
+  if (globalContext->cacheObjects) {
+    cache = new services::ObjectCache(configFolder / "cache");
+    cache->setDependencyGraph(dependencyGraph);
+  }
+
+  // Generating the LLVM IR touches the shared snowball IR, so it's done
+  // sequentially. Each builder owns its own LLVM context, which allows
+  // the (much more expensive) optimization and emission to run in parallel.
+  std::vector<codegen::LLVMBuilder*> builders;
+  std::vector<std::string> objects;
+  for (size_t i = 0; i < units.size(); ++i) {
+    auto builder = createBuilder(units[i]);
+    bool generated = false;
+    auto generate = [&]() {
+      llvm::TimeTraceScope timeScope("Codegen", units[i]->getName());
+      builder->codegen();
+      generated = true;
+    };
+    if (cache) {
+      auto unit = units[i]->getUniqueName();
+      auto options = std::to_string((int) opt_level) + ":" + std::to_string(testsEnabled) + ":" +
+              std::to_string(benchmarkEnabled) + ":" + builder->getTargetDescription() + ":" +
+              utils::hashToString(profileHash) + ":" + globalContext->passPipeline + ":";
+      objects.push_back(cache->getObjectPath(unit).string());
+      // Units whose sources didn't change aren't even generated. The rest
+      // are keyed by the code they generate.
+      uint64_t hash;
+      if (auto sourceHash = getUnitSourceHash(cache, units[i], cwd)) {
+        hash = utils::hashString(options + "src:" + utils::hashToString(*sourceHash));
+      } else {
+        generate();
+        hash = utils::hashString(options + "ir:" + utils::hashToString(builder->getModuleHash()));
+      }
+      cache->setObject(unit, hash);
+      if (cache->isUpToDate(unit, hash)) {
+        DEBUG_CODEGEN("Reusing object file for module %s (%s)", unit.c_str(), objects.back().c_str());
+        builders.push_back(nullptr);
+        continue;
+      }
+      if (!generated) generate();
+    } else {
+      objects.push_back(out + "." + std::to_string(i) + ".o");
+      generate();
+    }
+    builders.push_back(builder);
+  }
+
+  DEBUG_CODEGEN("Emitting %i object files using %i threads", (int) builders.size(), utils::getJobCount(globalContext->codegenJobs));
+  utils::parallelFor(builders.size(), globalContext->codegenJobs, [&](size_t i) {
+    if (!builders[i]) return;
+    llvm::TimeTraceScope timeScope("Backend", units[i]->getName());
+    builders[i]->optimizeModule();
+    llvm::TimeTraceScope emitScope("EmitObject", objects[i]);
+    builders[i]->emitObjectFile(objects[i], false);
+  });
+
+  // Only written once every object got emitted, so that a failed
+  // build never leaves stale objects marked as up to date.
+  if (cache) cache->save();
+  return objects;
+}
+
 int Compiler::emitBinary(std::string out, bool log) {
   std::vector<std::string> extraLinkerArgs = {};
-  auto objfile = linker::Linker::getSharedLibraryName(out);
-  DEBUG_CODEGEN("Emitting object file... (%s)", objfile.c_str());
-  int objstatus = emitObject(objfile, false);
-  if (objstatus != EXIT_SUCCESS) return objstatus;
+  std::vector<std::string> objects;
+  if (globalContext->codegenJobs != 1 || globalContext->cacheObjects) {
+    objects = emitObjects(out);
+  } else {
+    auto objfile = linker::Linker::getSharedLibraryName(out);
+    DEBUG_CODEGEN("Emitting object file... (%s)", objfile.c_str());
+    int objstatus = emitObject(objfile, false);
+    if (objstatus != EXIT_SUCCESS) return objstatus;
+    objects.push_back(objfile);
+  }
   auto linker = linker::Linker(globalContext, LD_PATH);
   for (auto lib : linkedLibraries) { linker.addLibrary(lib); }
   // TODO: add user-defined extra ld args
-  linker.link(objfile, out, extraLinkerArgs);
+  {
+    llvm::TimeTraceScope timeScope("Link", out);
+    linker.link(objects, out, extraLinkerArgs);
+  }
   if (log) Logger::success(Logger::format("Snowball project successfully compiled! 🥳", BGRN, RESET, out.c_str()));
 
-  // clean up
-  DEBUG_CODEGEN("Cleaning up object file... (%s)", objfile.c_str());
-  remove(objfile.c_str());
+  // clean up (cached objects are kept for the next build)
+  if (globalContext->cacheObjects) return EXIT_SUCCESS;
+  for (auto& objfile : objects) {
+    DEBUG_CODEGEN("Cleaning up object file... (%s)", objfile.c_str());
+    remove(objfile.c_str());
+  }
   return EXIT_SUCCESS;
 }
 
+int Compiler::executeJIT(std::vector<std::string> args) {
+  auto builder = createBuilder();
+  builder->codegen();
+  builder->optimizeModule();
+
+  // Same libraries the linker would use. The runtime is usually already loaded
+  // into the compiler's process, but the installed one takes precedence.
+  std::vector<std::string> libraries;
+  std::string runtime = "libsnowballrt";
+  auto runtimePath = utils::get_lib_folder() / ".." / _SNOWBALL_LIBRARY_OBJ / linker::Linker::getSharedLibraryName(runtime);
+  if (fs::exists(runtimePath)) libraries.push_back(runtimePath.string());
+  for (auto& lib : linkedLibraries) {
+    auto path = linker::Linker::findLibrary(lib);
+    if (path.empty()) throw SNError(Error::LINKER_ERR, FMT("Could not find library '%s' to run with the JIT", lib.c_str()));
+    libraries.push_back(path);
+  }
+
+  return builder->executeJIT(args, libraries);
+}
+
 int Compiler::emitSnowballIr(std::string p_output, bool p_pmessage) {
   auto builder = new codegen::SnowballIREmitter(module);
   builder->codegen(p_output);
@@ -9,6 +9,8 @@
 #include "./visitors/documentation/DocGen.h"
 
 #include <filesystem>
+#include <map>
+#include <set>
 #include <string>
 
 namespace fs = std::filesystem;
@@ -16,6 +18,9 @@ namespace fs = std::filesystem;
 #define __SNOWBALL_COMPILER_H_
 
 namespace snowball {
+namespace codegen {
+class LLVMBuilder;
+} // namespace codegen
 
 /**
  * @brief Global context for the compiler
@@ -33,6 +38,24 @@ struct GlobalContext {
 
   bool isDynamic = true;
   app::Options::Optimization opt = app::Options::Optimization::OPTIMIZE_O0;
+
+  // Number of threads used for code generation. If it's greater than 1,
+  // each module is generated into its own object file.
+  unsigned codegenJobs = 1;
+  // Reuse the object files of the modules whose generated code didn't
+  // change since the last build (stored inside ".sn/cache").
+  bool cacheObjects = false;
+  // Spawn the system linker even if snowball was built with
+  // in-process linking support (see `SNOWBALL_USE_LLD`).
+  bool systemLinker = false;
+  // CPU (and features) the code is generated for. Empty means a generic
+  // CPU of the host's architecture.
+  app::Options::TargetOptions target;
+  // Profile guided optimization (the folder is absolute once the
+  // compiler got initialized).
+  app::Options::ProfileOptions profile;
+  // Custom optimization pipeline (see `opt -passes`), empty for the default one.
+  std::string passPipeline;
 };
 
 /**
@@ -59,6 +82,15 @@ class Compiler {
   bool benchmarkEnabled = false;
 
   std::shared_ptr<ir::MainModule> module;
+  // Files imported by each source file (all paths are absolute)
+  std::map<fs::path, std::set<fs::path>> dependencyGraph;
+  // Where the time trace is written to (empty if it's not enabled)
+  fs::path timeTraceFile;
+  // Profile written by the instrumented program or the (indexed) profile
+  // used to optimize, depending on the profile mode.
+  fs::path profileFile;
+  // Hash of the profile, objects optimized with a different one can't be reused.
+  uint64_t profileHash = 0;
 
 public:
   Compiler(std::string p_code, std::string p_path);
@@ -88,7 +120,8 @@ public:
   int emitLLVMIr(std::string, bool = true);
   int emitASM(std::string, bool = true);
   int emitSnowballIr(std::string, bool = true);
-  int emitDocs(std::string, std::string, BasicPackageInfo, bool = true);
+  int emitDocs(std::string, std::string, BasicPackageInfo, bool = true, unsigned = 0, bool = false);
+  int executeJIT(std::vector<std::string> args);
 
   GlobalContext* getGlobalContext() { return globalContext; }
 
@@ -96,10 +129,37 @@ public:
     globalContext->opt = o;
     opt_level = o;
   }
+  void setCodegenJobs(unsigned jobs) { globalContext->codegenJobs = jobs; }
+  void setCacheObjects(bool cacheObjects) { globalContext->cacheObjects = cacheObjects; }
+  void setSystemLinker(bool systemLinker) { globalContext->systemLinker = systemLinker; }
+  void setTarget(app::Options::TargetOptions target) { globalContext->target = target; }
+  void setPassPipeline(std::string pipeline) { globalContext->passPipeline = pipeline; }
+  /**
+   * @brief Enable profile guided optimization. Instrumented programs write
+   *  their profile into, and optimized builds read it from, the folder given
+   *  in the options (".sn/profile" if it's empty).
+   * @note It must be called after the optimization level is set.
+   */
+  void setProfile(app::Options::ProfileOptions profile);
+  /**
+   * @brief Record where the compilation time is spent. The trace is written
+   *  (in the Chrome trace format) to @param file, or to ".sn/time-trace.json"
+   *  if it's empty, once the compiler is cleaned up.
+   */
+  void enableTimeTrace(std::string file);
 
 private:
   // methods
   void createSourceInfo();
+  /// @brief Create a builder for the whole program, or only for @param unit if given.
+  codegen::LLVMBuilder* createBuilder(std::shared_ptr<ir::Module> unit = nullptr);
+  /**
+   * @brief Generate one object file for each module, optimizing and
+   *  emitting them in parallel. With `-cache-objects`, the objects whose
+   *  generated code did not change are reused instead.
+   * @return The paths of the generated object files.
+   */
+  std::vector<std::string> emitObjects(std::string out);
   void runPackageManager(bool silent);
 };
 } // namespace snowball
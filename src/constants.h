@@ -92,6 +92,9 @@ typedef int32_t snowball_int_t;
 #define SN_INT_MAX_POWER 8388608
 #define SN_MAX_MACRO_DEPTH 2048 
 
+// Minimum duration (in microseconds) of the events recorded by `--time-trace`
+#define _SNOWBALL_TIME_TRACE_GRANULARITY 100
+
 #define UNREACHABLE                                                                                                    \
   do { std::abort(); } while (0);
 
@@ -195,10 +198,19 @@ typedef int32_t snowball_int_t;
 #define _SNOWBALL_PACKAGES_DIR ".sn" PATH_SEPARATOR "deps"
 #endif
 
+#ifndef _SNOWBALL_CACHE_DIR
+#define _SNOWBALL_CACHE_DIR ".sn" PATH_SEPARATOR "cache"
+#endif
+
 #ifndef _SNOWBALL_LLVM_PACKAGE_VERSION
 #error "_SNOWBALL_LLVM_PACKAGE_VERSION must be defined! (e.g. \"16.0.6\")"
 #endif
 
+// compiler-rt's profile runtime (linked with -profile-generate), it may not be installed
+#ifndef _SNOWBALL_PROFILE_RUNTIME
+#define _SNOWBALL_PROFILE_RUNTIME ""
+#endif
+
 // path of ld compiler used for linking
 #ifndef LD_PATH
 #error "LD_PATH must be defined! (e.g. \"/usr/bin/ld\")"
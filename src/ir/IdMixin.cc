@@ -6,7 +6,7 @@
 namespace snowball {
 namespace ir {
 
-id_t IdMixin::currentId = 0;
+std::atomic<id_t> IdMixin::currentId = 0;
 void IdMixin::resetId() { currentId = 0; }
 
 } // namespace ir
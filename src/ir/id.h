@@ -1,4 +1,5 @@
 
+#include <atomic>
 #include <cstdint>
 #include <stdio.h>
 
@@ -13,8 +14,8 @@ using id_t = std::uint64_t;
 /// Mixin class for IR nodes that need ids.
 class IdMixin {
 private:
-  /// the global id counter
-  static id_t currentId;
+  /// the global id counter (nodes may be created from multiple threads)
+  static std::atomic<id_t> currentId;
 
   IdMixin& operator=(const IdMixin&) = delete;
 
@@ -27,7 +28,7 @@ public:
   static void resetId();
 
   IdMixin(const IdMixin&) = default;
-  IdMixin() : id(currentId++) { }
+  IdMixin() : id(currentId.fetch_add(1, std::memory_order_relaxed)) { }
 
   /// @return the node's id.
   virtual id_t getId() const { return id; }
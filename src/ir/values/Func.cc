@@ -5,11 +5,22 @@
 #include "../../utils/utils.h"
 #include "Argument.h"
 
+#include <cassert>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace snowball {
 namespace ir {
 
+#if _SN_DEBUG
+namespace {
+// Every mangled name handed out so far, to catch two functions sharing one.
+std::mutex manglesMutex;
+std::unordered_map<std::string, id_t> mangles;
+} // namespace
+#endif
+
 Func::Func(std::string identifier, bool declaration, bool variadic, bool isAnon, types::DefinedType* parent)
     : declaration(declaration), variadic(variadic), identifier(identifier), parent(parent), anon(isAnon) { }
 
@@ -50,6 +61,10 @@ bool Func::isConstructor() const {
   return (services::OperatorService::opEquals<services::OperatorService::CONSTRUCTOR>(identifier)) && hasParent();
 }
 
+bool Func::isDestructor() const {
+  return (services::OperatorService::opEquals<services::OperatorService::DESTRUCTOR>(identifier)) && hasParent();
+}
+
 std::string Func::getIdentifier() { return identifier; }
 std::string Func::getName(bool ignoreOperators) {
   if (services::OperatorService::isOperator(identifier) && (!ignoreOperators)) {
@@ -107,8 +122,7 @@ std::string Func::getMangle() {
   }
 
   std::string prefix = (utils::startsWith(base, _SN_MANGLE_PREFIX) ? base : (_SN_MANGLE_PREFIX + base)) + +"&" +
-          std::to_string(name.size()) + name // Function name with modules
-          + "Cv" + std::to_string(getId());  // disambiguator
+          std::to_string(name.size()) + name; // Function name with modules
 
   std::string mangledArgs = "Sa"; // Start args tag
 
@@ -118,7 +132,24 @@ std::string Func::getMangle() {
     argCounter++;
   }
 
-  std::string mangled = prefix + mangledArgs + "FnE"; // FnE = end of function
+  // The disambiguator only depends on the declaration. It must not depend
+  // on the order in which functions get transformed, otherwise editing one
+  // module could rename symbols of another one whose object gets reused.
+  std::string key = module->getUniqueName() + "#" + std::to_string(declarationIndex);
+  for (auto [_, g] : getGenerics()) key += "," + g->getMangledName();
+  // Lambdas are declared once but instantiated for every instance of the
+  // (generic) function they are declared in.
+  if (auto scope = getParentScope()) key += "@" + scope->getMangle();
+  auto disambiguator = "Cv" + utils::hashToString(utils::hashString(key));
+
+  std::string mangled = prefix + disambiguator + mangledArgs + "FnE"; // FnE = end of function
+#if _SN_DEBUG
+  {
+    std::lock_guard<std::mutex> lock(manglesMutex);
+    auto [it, inserted] = mangles.emplace(mangled, getId());
+    assert((inserted || it->second == getId()) && "Two different functions got the same mangled name");
+  }
+#endif
   return mangled;
 }
 
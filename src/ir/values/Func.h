@@ -101,6 +101,11 @@ private:
   ///  is declared inside a class or not, etc...
   int scopeIndex = -1;
 
+  /// @brief Position of the declaration of this function inside the
+  ///  source file of its module. It identifies the function in its
+  ///  mangled name.
+  unsigned int declarationIndex = 0;
+
   /// @brief Parent scope where the anon. function is declared in.
   ///  This is used for things such as; determining if a function
   ///  is declared inside a class or not, etc...
@@ -110,6 +115,14 @@ private:
   ///  scope.
   bool _usesParentScope = false;
 
+  /// @brief If the anon. function's context may outlive the function
+  ///  creating it. Set by the escape analysis, heap allocated by default.
+  bool _escapes = true;
+
+  /// @brief If the closure environment of this function may outlive it.
+  ///  Set by the escape analysis, heap allocated by default.
+  bool _closureEscapes = true;
+
   Func(const Func&) = delete;
   Func& operator=(Func const&);
 
@@ -199,6 +212,8 @@ public:
   auto isStatic() { return _static; }
   /// @return true if the function is a class contructor
   bool isConstructor() const;
+  /// @return true if the function is a class destructor
+  bool isDestructor() const;
   /// @return true if the function is an anonymous function
   bool isAnon() const { return anon; }
 
@@ -207,6 +222,11 @@ public:
   /// @return the scope index where the function is declared in.
   auto getScopeIndex() const { return scopeIndex; }
 
+  /// @brief Set the position of the function's declaration in its source file.
+  void setDeclarationIndex(unsigned int x) { declarationIndex = x; }
+  /// @return the position of the function's declaration in its source file.
+  auto getDeclarationIndex() const { return declarationIndex; }
+
   /// @brief Set the parent scope where the function is declared in.
   void setParentScope(std::shared_ptr<Func> x) { parentScope = x; }
   /// @return the parent scope where the function is declared in.
@@ -217,6 +237,16 @@ public:
   /// @return true if the function uses variables from the parent scope.
   auto usesParentScope() const { assert(isAnon()); return _usesParentScope; }
 
+  /// @brief Set if the anon. function's context escapes its creator.
+  void setEscapes(bool x = true) { assert(isAnon()); _escapes = x; }
+  /// @return true if the anon. function's context must be heap allocated.
+  auto escapes() const { assert(isAnon()); return _escapes; }
+
+  /// @brief Set if the closure environment escapes the function.
+  void setClosureEscapes(bool x = true) { _closureEscapes = x; }
+  /// @return true if the closure environment must be heap allocated.
+  auto closureEscapes() const { return _closureEscapes; }
+
   // Set a visit handler for the generators
   SN_GENERATOR_VISITS
 public:
@@ -29,6 +29,8 @@ class Variable : public IdMixin, public AcceptorExtend<Variable, Value> {
   bool _isUsedInLambda = false;
   // Function where the variable is defined in
   Func* parentFunc = nullptr;
+  // Whether or not the variable owns its value and has to destroy it
+  bool _needsDrop = false;
 
 public:
   // Create a new variable declaration
@@ -51,6 +53,10 @@ public:
   auto getParentFunc() { assert(isUsedInLambda()); return parentFunc; }
   /// @brief Set the function where the variable is defined in
   void setParentFunc(Func* func) { assert(isUsedInLambda()); parentFunc = func; }
+  /// @return true if the value has to be destroyed once the variable goes out of scope
+  auto needsDrop() { return _needsDrop; }
+  /// @brief Set if the variable owns its value (see EscapeAnalysis)
+  void setNeedsDrop(bool drop = true) { _needsDrop = drop; }
 
   // Set a visit handler for the generators
   SN_GENERATOR_VISITS
@@ -361,7 +361,7 @@ void Lexer::tokenize() {
 
         Token tk = {};
         tk.type = TokenType::VALUE_CHAR;
-        tk.value = str; // method name may be builtin func
+        tk.value = internString(str); // method name may be builtin func
         tk.col = cur_col - ((int) str.size() + (2 /* speech marks */));
         tk.line = cur_line;
         tokens.emplace_back(tk);
@@ -466,7 +466,7 @@ void Lexer::tokenize() {
 
         Token tk = {};
         tk.type = TokenType::VALUE_STRING;
-        tk.value = str; // method name may be builtin func
+        tk.value = internString(str); // method name may be builtin func
         tk.col = col-1;
         tk.line = line;
         tokens.emplace_back(tk);
@@ -486,12 +486,12 @@ void Lexer::tokenize() {
             EAT_CHAR(1);
           }
 
-          double float_val = std::stod(float_str);
           Token tk = {};
           tk.type = TokenType::VALUE_FLOAT;
           tk.line = cur_line;
           tk.col = cur_col - float_str.length();
-          tk.value = float_val;
+          // Kept as written, formatting it would round away small values
+          tk.value = internString("0" + float_str);
           tokens.emplace_back(tk);
           break;
         }
@@ -568,7 +568,7 @@ void Lexer::tokenize() {
           Token tk = {};
           tk.line = cur_line;
           tk.col = cur_col - num.length();
-          tk.value = num;
+          tk.value = internString(num);
           if (mode == FLOAT) {
             tk.type = TokenType::VALUE_FLOAT;
           } else {
@@ -600,7 +600,7 @@ void Lexer::tokenize() {
             .type = TokenType::UNKNOWN,
             .line = cur_line,
             .col = cur_col - (int) identifier.size(),
-            .value = identifier
+            .value = internString(identifier)
           };
 
           if (identifier == _SNOWBALL_KEYWORD__NEW) {
@@ -701,7 +701,7 @@ void Lexer::tokenize() {
             case TokenType::KWORD_CONST:
             case TokenType::KWORD_TYPEDEF:
             case TokenType::KWORD_OPERATOR:
-              tk.comment = comments;
+              tk.comment = internString(comments);
               comments = "";
               break;
 
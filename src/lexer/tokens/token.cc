@@ -0,0 +1,30 @@
+#include "token.h"
+
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+namespace snowball {
+
+namespace {
+// A deque never moves its elements, so the views stay valid.
+std::deque<std::string> storage;
+std::unordered_set<std::string_view> interned;
+std::mutex mutex;
+} // namespace
+
+std::string_view internString(std::string_view str) {
+  if (str.empty()) return {};
+  std::lock_guard<std::mutex> lock(mutex);
+  if (auto it = interned.find(str); it != interned.end()) return *it;
+  auto& stored = storage.emplace_back(str);
+  return *interned.insert(stored).first;
+}
+
+void clearInternedStrings() {
+  std::lock_guard<std::mutex> lock(mutex);
+  interned.clear();
+  storage.clear();
+}
+
+} // namespace snowball
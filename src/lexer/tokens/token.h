@@ -3,6 +3,7 @@
 #include "utils/logger.h"
 
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -203,14 +204,35 @@ enum class TokenType
   UNKNOWN, // Other
 };
 
+/**
+ * @brief Store a string for the rest of the compilation.
+ *
+ * Tokens don't own their text, they point to an interned copy of it
+ * instead. This makes tokens trivially copyable and every identifier
+ * is only stored once, no matter how many times it appears.
+ *
+ * @return A view to the interned string.
+ */
+std::string_view internString(std::string_view str);
+/**
+ * @brief Release every interned string.
+ *
+ * The AST copies the text it needs out of the tokens, so this is called
+ * once a compilation is done parsing. Tokens created before must not be
+ * used afterwards.
+ */
+void clearInternedStrings();
+
 struct Token {
   TokenType type = TokenType::UNKNOWN;
   int line = 0, col = 0;
 
-  std::string value;
-  std::string comment = "";
+  /// @brief The text of identifiers and literals (see `internString`).
+  std::string_view value;
+  /// @brief Documentation comment that precedes the token.
+  std::string_view comment;
 
-  std::string getComment() const { return comment; }
+  std::string getComment() const { return std::string(comment); }
 
   std::string to_string() const {
     switch (type) {
@@ -274,7 +296,7 @@ struct Token {
       case TokenType::OP_BIT_RSHIFT_EQ: return ">>=";
 
       // Identifiers
-      case TokenType::IDENTIFIER: return value;
+      case TokenType::IDENTIFIER: return std::string(value);
 
       // Keywods
       case TokenType::KWORD_PUBLIC: return _SNOWBALL_KEYWORD__PUBLIC;
@@ -322,10 +344,10 @@ struct Token {
 
       case TokenType::VALUE_NUMBER:
       case TokenType::VALUE_FLOAT:
-      case TokenType::VALUE_BOOL: return value;
+      case TokenType::VALUE_BOOL: return std::string(value);
 
-      case TokenType::VALUE_STRING: return std::string("\"") + value + "\"";
-      case TokenType::VALUE_CHAR: return FMT("'%s'", value.c_str());
+      case TokenType::VALUE_STRING: return "\"" + std::string(value) + "\"";
+      case TokenType::VALUE_CHAR: return "'" + std::string(value) + "'";
 
       // Other
       case TokenType::UNKNOWN: return "<unknown>";
@@ -7,43 +7,48 @@ namespace snowball {
 namespace parser {
 
 Parser::Parser(std::vector<Token> p_tokens, const SourceInfo* p_source_info, bool p_allow_comments)
-    : m_tokens(p_tokens), m_source_info(p_source_info), m_allow_comments(p_allow_comments) {
+    : m_tokens(std::move(p_tokens)), m_source_info(p_source_info), m_allow_comments(p_allow_comments) {
   m_current = m_tokens.at(m_tok_index);
 }
 
 std::vector<Syntax::Node*> Parser::parse() { return parseGlobal(); }
 
-Token Parser::next(int p_offset) {
+namespace {
+// Returned when there are no more tokens to look at.
+const Token EOF_TOKEN = {.type = TokenType::_EOF};
+const Token UNKNOWN_TOKEN = {};
+} // namespace
+
+const Token& Parser::next(int p_offset) {
   try {
     m_tok_index += (p_offset + 1);
     m_current = m_tokens.at(m_tok_index);
-    return m_current;
+    return m_tokens[m_tok_index];
   } catch (std::out_of_range& _) { createError<BUG>("Index error"); }
 
-  return {};
+  return UNKNOWN_TOKEN;
 }
 
-Token Parser::prev(int p_offset, bool p_safe) {
+const Token& Parser::prev(int p_offset, bool p_safe) {
   try {
     m_tok_index -= (p_offset + 1);
     m_current = m_tokens.at(m_tok_index);
-    return m_current;
+    return m_tokens[m_tok_index];
   } catch (std::out_of_range& _) {
     if (!p_safe) createError<BUG>("Index error");
   }
 
-  return {};
+  return UNKNOWN_TOKEN;
 }
 
-Token Parser::peek(int p_offset, bool p_safe) {
-  Token tmp = {.type=TokenType::_EOF,. value=""};
+const Token& Parser::peek(int p_offset, bool p_safe) {
   if ((m_tok_index + 1) + p_offset < 0 || (m_tok_index + 1) + p_offset >= (int) m_tokens.size()) {
     if (p_safe)
-      return tmp;
+      return EOF_TOKEN;
     else
       createError<BUG>("Parser::peek() index out of bounds");
   }
-  return m_tokens.at((m_tok_index + 1) + p_offset);
+  return m_tokens[(m_tok_index + 1) + p_offset];
 }
 } // namespace parser
 } // namespace snowball
@@ -33,6 +33,8 @@ class Parser {
 
   bool m_inside_loop = false;
   bool m_allow_comments = false;
+  /// Number of functions (lambdas included) parsed so far
+  unsigned int m_function_count = 0;
 
 public:
   Parser(std::vector<Token> p_tokens, const SourceInfo* p_source_info, bool p_allow_comments = false);
@@ -69,7 +71,7 @@ private:
   }
   // Check if a token type is a certain type
   template <TokenType Ty>
-  bool is(Token p_tok) const {
+  bool is(const Token& p_tok) const {
     return p_tok.type == Ty;
   }
   // Comparison between 2 token types
@@ -80,7 +82,7 @@ private:
 
   // Check if a token mactches any of 2 types
   template <TokenType Ty, TokenType Ty2>
-  bool is(Token p_tok) const {
+  bool is(const Token& p_tok) const {
     return p_tok.type == Ty || p_tok.type == Ty2;
   }
 
@@ -92,7 +94,7 @@ private:
    * @return next token
    */
   template <TokenType Ty>
-  Token consume(std::string expectation) {
+  const Token& consume(const std::string& expectation) {
     assert_tok<Ty>(expectation);
     return next();
   }
@@ -130,7 +132,7 @@ private:
    * @return given token
    */
   template <TokenType Ty>
-  Token assert_tok(std::string expectation) {
+  const Token& assert_tok(const std::string& expectation) {
     if (!is<Ty>()) {
       createError<SYNTAX_ERROR>(
               FMT("Expected %s but got '%s'",
@@ -139,18 +141,18 @@ private:
       );
     }
 
-    return m_current;
+    return m_tokens[m_tok_index];
   }
 
   // Increment @var "m_tok_index" and
   // return the current token
-  Token next(int p_offset = 0);
+  const Token& next(int p_offset = 0);
   // Increment @var "m_tok_index" (+ offset) and
   // return the respective token for that index.
-  Token peek(int p_offset = 0, bool p_safe = false);
+  const Token& peek(int p_offset = 0, bool p_safe = false);
   // Decrement @var "m_tok_index" and
   // return the current token
-  Token prev(int p_offset = 0, bool p_safe = false);
+  const Token& prev(int p_offset = 0, bool p_safe = false);
   /**
    * Joins a list of expressions into a single expression tree that
    * follows the order of operations defined by BIDMAS (Brackets,
@@ -352,7 +354,7 @@ private:
 
   /// @brief Parses a statement
   /// @return a statement
-  Syntax::Node* parseStatement(Token pk);
+  Syntax::Node* parseStatement(const Token& pk);
 
   /**
    * @brief Parses a list of attributes
@@ -191,6 +191,29 @@ Syntax::Statement::DefinedTypeDef* Parser::parseClass() {
         cls->addFunction(func);
       } break;
 
+      case TokenType::OP_BIT_NOT: {
+        if (!IS_CONSTRUCTOR(peek())) {
+          next();
+          createError<SYNTAX_ERROR>(FMT("Expected the class name ('%s') after '~' for a destructor declaration!", name.c_str()));
+        } else if (isInterface) {
+          createError<SYNTAX_ERROR>("Interfaces can't have destructors!");
+        }
+
+        auto func = parseFunction();
+        if (func->getArgs().size() > 0) {
+          createError<SYNTAX_ERROR>(
+                  "Destructors can't have arguments!",
+                  {.info = "Destructors are called implicitly when the object goes out of scope."}
+          );
+        }
+
+        // Destructors are called implicitly, so they are always public.
+        func->setPrivacy(Syntax::Statement::Privacy::PUBLIC);
+        func->setName(services::OperatorService::getOperatorMangle(services::OperatorService::DESTRUCTOR));
+        func->isMutable(true);
+        cls->addFunction(func);
+      } break;
+
       case TokenType::KWORD_MUTABLE: {
         auto pk = peek();
         if (pk.type != TokenType::KWORD_FUNC && pk.type != TokenType::KWORD_OPERATOR &&
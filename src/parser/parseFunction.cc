@@ -18,7 +18,7 @@ using namespace snowball::Syntax::Statement;
 namespace snowball::parser {
 
 FunctionDef* Parser::parseFunction(bool isConstructor, bool isOperator, bool isLambda, bool allowDecl) {
-  assert((is<TokenType::KWORD_FUNC>() && (!isConstructor && !isOperator)) ||
+  assert(((is<TokenType::KWORD_FUNC>() || is<TokenType::OP_BIT_NOT>()) && (!isConstructor && !isOperator)) ||
          (is<TokenType::IDENTIFIER>() && (isConstructor && !isOperator)) || (isOperator));
 
   auto comment = parseDocstring(m_current.getComment());
@@ -620,6 +620,7 @@ fetch_attrs:
   fn->setStatic(isStatic);
   fn->isMutable(isMutable);
   fn->setComment(comment);
+  fn->setDeclarationIndex(m_function_count++);
   return fn;
 }
 
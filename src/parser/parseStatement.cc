@@ -7,7 +7,7 @@
 
 namespace snowball::parser {
 
-Syntax::Node* Parser::parseStatement(Token pk) {
+Syntax::Node* Parser::parseStatement(const Token& pk) {
   switch (pk.type) {
     case TokenType::_EOF: {
       next(); // eat EOF
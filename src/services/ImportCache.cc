@@ -21,6 +21,8 @@ ImportCache::getModule(fs::path p) {
     return i == modules.end() ? std::nullopt :
         std::make_optional<std::shared_ptr<ir::Module>>(i->second);
 }
+void ImportCache::addDependency(fs::path p, fs::path dependency)
+    { dependencies[p].insert(dependency); }
 
 // clang-format on
 
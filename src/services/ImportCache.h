@@ -4,6 +4,7 @@
 #include <filesystem>
 #include <map>
 #include <optional>
+#include <set>
 
 #ifndef __SNOWBALL_IMPORT_CACHE_H_
 #define __SNOWBALL_IMPORT_CACHE_H_
@@ -19,6 +20,9 @@ class ImportCache {
   /// @brief A map containing the stored modules.
   /// @note The map key is a full abstract path.
   std::map<std::filesystem::path, std::shared_ptr<ir::Module>> modules;
+  /// @brief The files imported by each source file.
+  /// @note Both the keys and the values are full abstract paths.
+  std::map<std::filesystem::path, std::set<std::filesystem::path>> dependencies;
 
 public:
   ImportCache() noexcept = default;
@@ -27,6 +31,10 @@ public:
   void addModule(std::filesystem::path p, std::shared_ptr<ir::Module> m);
   /// @return a shared pointer to a module if it exists inside the map
   std::optional<std::shared_ptr<ir::Module>> getModule(std::filesystem::path p);
+  /// @brief Record that the source file `p` imports the file `dependency`
+  void addDependency(std::filesystem::path p, std::filesystem::path dependency);
+  /// @return the import graph of all the source files used at compile time
+  const auto& getDependencies() const { return dependencies; }
 
   ~ImportCache() noexcept = default;
 };
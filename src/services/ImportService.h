@@ -1,6 +1,9 @@
 
 #include "../common.h"
 #include "ImportCache.h"
+#include "PrecompiledCache.h"
+
+#include <memory>
 
 #ifndef __SNOWBALL_SERVICES_IMPORT_H_
 #define __SNOWBALL_SERVICES_IMPORT_H_
@@ -26,9 +29,13 @@ public:
   std::filesystem::path currentPackagePath;
   /// @brief Root path to the packages folder
   std::filesystem::path packagesPath;
+  /// @brief Cache used to avoid lexing and parsing unchanged modules.
+  std::unique_ptr<PrecompiledCache> precompiled;
 
 public:
-  ImportService(std::filesystem::path packagesPath) : packagesPath(packagesPath) {}
+  ImportService(std::filesystem::path packagesPath)
+      : packagesPath(packagesPath),
+        precompiled(std::make_unique<PrecompiledCache>(packagesPath / _SNOWBALL_CACHE_DIR)) {}
   /**
    * @brief Get the package path based on it's identifier
    * @note if package name is "pkg" it will return the current package
@@ -0,0 +1,133 @@
+
+#include "ObjectCache.h"
+
+#include "../constants.h"
+#include "../utils/utils.h"
+
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace snowball {
+namespace services {
+
+namespace {
+// Bump this every time the layout of the manifest changes.
+const uint32_t MANIFEST_FORMAT_VERSION = 3;
+const char* MANIFEST_NAME = "objects.json";
+} // namespace
+
+ObjectCache::ObjectCache(fs::path cacheFolder) : cacheFolder(cacheFolder) {
+  current = {
+          {"format", MANIFEST_FORMAT_VERSION},
+          {"version", _SNOWBALL_VERSION_NUMBER},
+          {"sources", nlohmann::json::object()},
+          {"units", nlohmann::json::object()}};
+
+  std::error_code ec;
+  fs::create_directories(cacheFolder / "objects", ec);
+
+  std::ifstream is(cacheFolder / MANIFEST_NAME);
+  if (!is.is_open()) return;
+  // Any invalid or outdated manifest is treated as if there was no previous build.
+  auto manifest = nlohmann::json::parse(is, nullptr, false);
+  if (manifest.is_discarded() || !manifest.is_object()) return;
+  if (manifest.value("format", 0u) != MANIFEST_FORMAT_VERSION) return;
+  if (manifest.value("version", (uint64_t) 0) != (uint64_t) _SNOWBALL_VERSION_NUMBER) return;
+  if (!manifest["sources"].is_object() || !manifest["units"].is_object()) return;
+  previous = manifest;
+}
+
+void ObjectCache::setDependencyGraph(const std::map<fs::path, std::set<fs::path>>& graph) {
+  this->graph = graph;
+  auto& sources = current["sources"];
+  auto addSource = [&](const fs::path& path) -> nlohmann::json& {
+    auto& entry = sources[path.string()];
+    if (entry.is_null()) {
+      entry = {{"imports", nlohmann::json::array()}};
+      std::ifstream is(path);
+      if (is.is_open()) {
+        std::string content((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+        auto hash = utils::hashString(content);
+        contentHashes[path] = hash;
+        entry["hash"] = utils::hashToString(hash);
+      }
+    }
+    return entry;
+  };
+
+  for (auto& [path, imports] : graph) {
+    auto& entry = addSource(path);
+    for (auto& dependency : imports) {
+      entry["imports"].push_back(dependency.string());
+      addSource(dependency);
+    }
+  }
+}
+
+std::optional<uint64_t> ObjectCache::getSourceHash(const fs::path& path) const {
+  if (!contentHashes.count(path)) return std::nullopt;
+
+  // Every file reachable from the source, sorted by path so that the
+  // hash doesn't depend on the order imports are visited in.
+  std::map<fs::path, uint64_t> reachable;
+  std::vector<fs::path> pending = {path};
+  while (!pending.empty()) {
+    auto file = pending.back();
+    pending.pop_back();
+    if (reachable.count(file)) continue;
+    auto hash = contentHashes.find(file);
+    // A file that couldn't be read can't be proven unchanged.
+    if (hash == contentHashes.end()) return std::nullopt;
+    reachable[file] = hash->second;
+    auto imports = graph.find(file);
+    if (imports == graph.end()) continue;
+    for (auto& dependency : imports->second) pending.push_back(dependency);
+  }
+
+  std::string key;
+  for (auto& [file, hash] : reachable) key += file.string() + "=" + utils::hashToString(hash) + ";";
+  return utils::hashString(key);
+}
+
+fs::path ObjectCache::getObjectPath(const std::string& unit) const {
+  return cacheFolder / "objects" / (utils::hashToString(utils::hashString(unit)) + ".o");
+}
+
+bool ObjectCache::isUpToDate(const std::string& unit, uint64_t hash) const {
+  if (previous.is_null() || !previous["units"].contains(unit)) return false;
+  if (previous["units"][unit] != utils::hashToString(hash)) return false;
+  return fs::exists(getObjectPath(unit));
+}
+
+void ObjectCache::setObject(const std::string& unit, uint64_t hash) {
+  current["units"][unit] = utils::hashToString(hash);
+}
+
+void ObjectCache::save() {
+  std::error_code ec;
+  fs::create_directories(cacheFolder, ec);
+  if (ec) return; // The cache is just an optimization, never fail because of it
+
+  auto manifest = cacheFolder / MANIFEST_NAME;
+  auto tmp = manifest;
+  tmp += "." + utils::gen_random<8>() + ".tmp";
+  {
+    std::ofstream os(tmp, std::ios::trunc);
+    if (!os.is_open()) return;
+    os << current.dump(2);
+    if (!os.good()) {
+      os.close();
+      fs::remove(tmp, ec);
+      return;
+    }
+  }
+
+  fs::rename(tmp, manifest, ec);
+  if (ec) fs::remove(tmp, ec);
+}
+
+} // namespace services
+} // namespace snowball
@@ -0,0 +1,79 @@
+
+#include "nlohmann/json.hpp"
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+
+#ifndef __SNOWBALL_OBJECT_CACHE_H_
+#define __SNOWBALL_OBJECT_CACHE_H_
+
+namespace snowball {
+namespace services {
+
+/**
+ * @brief It keeps track of what got built on the previous build so that
+ *  unchanged modules don't have to be optimized and emitted again.
+ *
+ * @details
+ * The manifest (`objects.json`) stores two things:
+ *  - The import graph of the project and the content hash of every
+ *    source file, which tells which source files a build depends on
+ *    (`-watch` uses it to know what to watch).
+ *  - The hash every codegen unit was built from. When the source of a
+ *    unit, everything it (transitively) imports and the sources of the
+ *    types its generic instances got created with are unchanged, the
+ *    stored object is reused without generating the unit at all (see
+ *    `getSourceHash`). Units that can't be traced back to source files
+ *    are keyed by the hash of their unoptimized LLVM module instead.
+ *
+ * @note Every module is still lexed, transformed and type checked on every
+ *  build: the IR can't be stored into the disk (IR values keep raw pointers
+ *  into the AST and into the transformer's types) and the declarations of
+ *  a module are needed to transform the modules importing it.
+ */
+class ObjectCache {
+  /// @brief Folder where the manifest and the objects are stored.
+  std::filesystem::path cacheFolder;
+  /// @brief Manifest written by the previous build.
+  nlohmann::json previous;
+  /// @brief Manifest for the current build.
+  nlohmann::json current;
+  /// @brief Import graph of the current build.
+  std::map<std::filesystem::path, std::set<std::filesystem::path>> graph;
+  /// @brief Content hash of every source file in the graph.
+  std::map<std::filesystem::path, uint64_t> contentHashes;
+
+public:
+  ObjectCache(std::filesystem::path cacheFolder);
+
+  /// @brief Record the import graph of the project and hash the contents
+  ///  of every source file in it.
+  void setDependencyGraph(const std::map<std::filesystem::path, std::set<std::filesystem::path>>& graph);
+  /**
+   * @return A hash of the contents of a source file and of every source
+   *  file it (transitively) imports, or nothing if the file is not part
+   *  of the import graph.
+   */
+  std::optional<uint64_t> getSourceHash(const std::filesystem::path& path) const;
+
+  /// @return The path where the object of a codegen unit is stored.
+  std::filesystem::path getObjectPath(const std::string& unit) const;
+  /// @return true if the stored object for the unit was built from the
+  ///  exact same hash.
+  bool isUpToDate(const std::string& unit, uint64_t hash) const;
+  /// @brief Record the hash of the code generated for a unit.
+  void setObject(const std::string& unit, uint64_t hash);
+
+  /// @brief Write the manifest for the next build.
+  void save();
+
+  ~ObjectCache() noexcept = default;
+};
+
+} // namespace services
+} // namespace snowball
+
+#endif // __SNOWBALL_OBJECT_CACHE_H_
@@ -0,0 +1,212 @@
+
+#include "PrecompiledCache.h"
+
+#include "../lexer/lexer.h"
+#include "../utils/utils.h"
+
+#include <cstring>
+#include <fstream>
+#include <llvm/Support/TimeProfiler.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace snowball {
+namespace services {
+
+namespace {
+// Bump this every time the layout of an entry (or the Token struct) changes.
+const uint32_t CACHE_FORMAT_VERSION = 2;
+const char CACHE_MAGIC[4] = {'S', 'N', 'P', 'C'};
+
+template <typename T>
+void write(std::ostream& os, const T& value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write(std::ostream& os, std::string_view value) {
+  write<uint32_t>(os, value.size());
+  os.write(value.data(), value.size());
+}
+
+/// @brief Reads an entry that has already been loaded into memory.
+struct Reader {
+  const char* cursor;
+  const char* end;
+
+  template <typename T>
+  bool read(T& value) {
+    if ((size_t) (end - cursor) < sizeof(T)) return false;
+    std::memcpy(&value, cursor, sizeof(T));
+    cursor += sizeof(T);
+    return true;
+  }
+
+  bool read(std::string_view& value) {
+    uint32_t size;
+    if (!read(size) || (size_t) (end - cursor) < size) return false;
+    value = internString(std::string_view(cursor, size));
+    cursor += size;
+    return true;
+  }
+};
+
+/// @brief Lex a source file from scratch.
+std::vector<Token> lexSource(const SourceInfo* srcInfo) {
+  llvm::TimeTraceScope timeScope("Lexer", srcInfo->getPath());
+  Lexer lexer(srcInfo);
+  lexer.tokenize();
+  return std::move(lexer.tokens);
+}
+
+parser::Parser::NodeVec parseTokens(std::vector<Token> tokens, const SourceInfo* srcInfo) {
+  llvm::TimeTraceScope timeScope("Parser", srcInfo->getPath());
+  auto parser = new parser::Parser(std::move(tokens), srcInfo);
+  return parser->parse();
+}
+} // namespace
+
+fs::path PrecompiledCache::getEntryPath(const fs::path& path) const {
+  auto absolute = fs::absolute(path).lexically_normal();
+  return cacheFolder / (absolute.stem().string() + "-" + utils::hashToString(utils::hashString(absolute.string())) + ".snc");
+}
+
+std::map<std::string, PrecompiledCache::MemoryEntry> PrecompiledCache::memory;
+pid_t PrecompiledCache::preloadingProcess = 0;
+
+void PrecompiledCache::preload(const fs::path& folder) {
+  std::error_code ec;
+  for (const auto& entry : fs::recursive_directory_iterator(folder, ec)) {
+    if (!entry.is_regular_file() || entry.path().extension() != ".sn") continue;
+    preloadFile(entry.path());
+  }
+}
+
+bool PrecompiledCache::preloadFile(const fs::path& path) {
+  preloadingProcess = getpid();
+  auto absolute = fs::absolute(path).lexically_normal().string();
+  std::ifstream ifs(path);
+  if (!ifs.is_open()) {
+    memory.erase(absolute);
+    return false;
+  }
+  std::string source((std::istreambuf_iterator<char>(ifs)), (std::istreambuf_iterator<char>()));
+  auto hash = utils::hashString(source);
+  if (auto entry = memory.find(absolute); entry != memory.end() && entry->second.hash == hash) return false;
+
+  // AST nodes keep pointing to their source, it lives as long as the entry.
+  auto srcInfo = new SourceInfo(source, path.string());
+  parser::Parser::NodeVec ast;
+  try {
+    ast = parseTokens(lexSource(srcInfo), srcInfo);
+  } catch (const SNError&) {
+    delete srcInfo;
+    memory.erase(absolute);
+    return false; // It will be reported once (and if) the file gets imported
+  }
+
+  memory[absolute] = {.hash = hash, .ast = std::move(ast)};
+  // The AST copied the text it needs out of the tokens.
+  clearInternedStrings();
+  return true;
+}
+
+parser::Parser::NodeVec PrecompiledCache::parse(const SourceInfo* srcInfo) {
+  // Only a forked process has a private copy of the preloaded AST
+  if (!memory.empty() && getpid() != preloadingProcess) {
+    auto entry = memory.find(fs::absolute(srcInfo->getPath()).lexically_normal().string());
+    if (entry != memory.end() && !entry->second.taken && entry->second.hash == utils::hashString(srcInfo->getSource())) {
+      entry->second.taken = true;
+      return entry->second.ast;
+    }
+  }
+
+  return parseTokens(tokenize(srcInfo), srcInfo);
+}
+
+std::optional<std::vector<Token>> PrecompiledCache::getTokens(const fs::path& path, const std::string& source) {
+  // Entries are small enough to be read at once, which is a lot faster
+  // than going through the stream for every field.
+  std::ifstream is(getEntryPath(path), std::ios::binary | std::ios::ate);
+  if (!is.is_open()) return std::nullopt;
+  std::string buffer(is.tellg(), '\0');
+  if (!is.seekg(0).read(buffer.data(), buffer.size())) return std::nullopt;
+  Reader reader {.cursor = buffer.data(), .end = buffer.data() + buffer.size()};
+
+  char magic[4];
+  uint32_t format;
+  uint64_t version, hash, size;
+  if (!reader.read(magic) || std::string(magic, 4) != std::string(CACHE_MAGIC, 4)) return std::nullopt;
+  if (!reader.read(format) || format != CACHE_FORMAT_VERSION) return std::nullopt;
+  if (!reader.read(version) || version != (uint64_t) _SNOWBALL_VERSION_NUMBER) return std::nullopt;
+  if (!reader.read(size) || size != source.size()) return std::nullopt;
+  if (!reader.read(hash) || hash != utils::hashString(source)) return std::nullopt;
+
+  uint32_t count;
+  if (!reader.read(count)) return std::nullopt;
+  std::vector<Token> tokens(count);
+  for (auto& tk : tokens) {
+    uint16_t type;
+    int32_t line, col;
+    if (!reader.read(type) || !reader.read(line) || !reader.read(col)) return std::nullopt;
+    if (type > (uint16_t) TokenType::UNKNOWN) return std::nullopt;
+    if (!reader.read(tk.value) || !reader.read(tk.comment)) return std::nullopt;
+    tk.type = (TokenType) type;
+    tk.line = line;
+    tk.col = col;
+  }
+
+  return tokens;
+}
+
+void PrecompiledCache::storeTokens(const fs::path& path, const std::string& source, const std::vector<Token>& tokens) {
+  std::error_code ec;
+  fs::create_directories(cacheFolder, ec);
+  if (ec) return; // The cache is just an optimization, never fail because of it
+
+  // Write into a temporary file first so that other compiler instances
+  // never read a half-written entry.
+  auto entry = getEntryPath(path);
+  auto tmp = entry;
+  tmp += "." + utils::gen_random<8>() + ".tmp";
+  {
+    std::ofstream os(tmp, std::ios::binary | std::ios::trunc);
+    if (!os.is_open()) return;
+
+    os.write(CACHE_MAGIC, 4);
+    write<uint32_t>(os, CACHE_FORMAT_VERSION);
+    write<uint64_t>(os, _SNOWBALL_VERSION_NUMBER);
+    write<uint64_t>(os, source.size());
+    write<uint64_t>(os, utils::hashString(source));
+    write<uint32_t>(os, tokens.size());
+    for (const auto& tk : tokens) {
+      write<uint16_t>(os, (uint16_t) tk.type);
+      write<int32_t>(os, tk.line);
+      write<int32_t>(os, tk.col);
+      write(os, tk.value);
+      write(os, tk.comment);
+    }
+
+    if (!os.good()) {
+      os.close();
+      fs::remove(tmp, ec);
+      return;
+    }
+  }
+
+  fs::rename(tmp, entry, ec);
+  if (ec) fs::remove(tmp, ec);
+}
+
+std::vector<Token> PrecompiledCache::tokenize(const SourceInfo* srcInfo) {
+  auto path = (fs::path) srcInfo->getPath();
+  auto source = srcInfo->getSource();
+  if (auto tokens = getTokens(path, source)) return std::move(*tokens);
+
+  auto tokens = lexSource(srcInfo);
+  storeTokens(path, source, tokens);
+  return tokens;
+}
+
+} // namespace services
+} // namespace snowball
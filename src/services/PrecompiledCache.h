@@ -0,0 +1,99 @@
+#include "../SourceInfo.h"
+#include "../lexer/tokens/token.h"
+#include "../parser/Parser.h"
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <sys/types.h>
+#include <vector>
+
+#ifndef __SNOWBALL_PRECOMPILED_CACHE_H_
+#define __SNOWBALL_PRECOMPILED_CACHE_H_
+
+namespace snowball {
+namespace services {
+
+/**
+ * @brief It caches the front end's work on modules so that unchanged
+ *  modules don't have to be processed again.
+ *
+ * @details
+ * There are two layers:
+ *  - The pre-processed (lexed) version of every module is stored into the
+ *    disk so that it can be reused between builds. Each entry is keyed by
+ *    the absolute path of the source file and it's only considered valid
+ *    if both the content hash of the source and the compiler version match
+ *    the ones stored in the entry. Any invalid, corrupted or outdated entry
+ *    is just ignored and rewritten.
+ *  - The parsed AST of a folder can be kept in memory (see `preload`),
+ *    which is what `snowball server` and `-watch` do with the standard
+ *    library before forking a process for every build.
+ *
+ * @note Transformed modules can't be stored since they reference AST
+ *  nodes and types owned by the transformer. Tokens are the last
+ *  self-contained stage of the pipeline.
+ */
+class PrecompiledCache {
+  /// @brief Folder where all the cache entries are stored.
+  std::filesystem::path cacheFolder;
+
+  struct MemoryEntry {
+    uint64_t hash;
+    parser::Parser::NodeVec ast;
+    /// @brief Whether the current process already got the AST.
+    bool taken = false;
+  };
+  /// @brief Entries kept in memory, keyed by absolute path. They are
+  ///  shared by every instance and only written by `preload`.
+  static std::map<std::string, MemoryEntry> memory;
+  /// @brief The process that called `preload`.
+  static pid_t preloadingProcess;
+
+public:
+  PrecompiledCache(std::filesystem::path cacheFolder) : cacheFolder(cacheFolder) {}
+
+  /**
+   * @brief Parse a source file, reusing the preloaded AST or the cached
+   *  token stream if they are still valid.
+   *
+   * @note The transformer annotates the AST it visits, so a preloaded AST
+   *  is only handed out to processes forked after `preload` (which have
+   *  their own copy of it), and only once per process.
+   */
+  parser::Parser::NodeVec parse(const SourceInfo* srcInfo);
+  /**
+   * @brief Tokenize a source file, reusing the cached token stream if it
+   *  is still valid or storing a new entry otherwise.
+   */
+  std::vector<Token> tokenize(const SourceInfo* srcInfo);
+  /// @return The cached tokens for a file if the entry is up to date.
+  std::optional<std::vector<Token>> getTokens(const std::filesystem::path& path, const std::string& source);
+  /// @brief Store a new entry (overwriting the old one if it exists).
+  void storeTokens(const std::filesystem::path& path, const std::string& source, const std::vector<Token>& tokens);
+
+  /**
+   * @brief Lex and parse every source file inside a folder and keep the
+   *  AST in memory for the rest of the process' lifetime.
+   * @note It's not thread safe, it must be called before compiling.
+   */
+  static void preload(const std::filesystem::path& folder);
+  /**
+   * @brief Same as `preload`, but for a single source file. A file whose
+   *  AST is already in memory is only parsed again if it changed, and it
+   *  is dropped from memory if it no longer exists or can't be parsed.
+   * @return true if the file got parsed.
+   */
+  static bool preloadFile(const std::filesystem::path& path);
+
+  ~PrecompiledCache() noexcept = default;
+
+private:
+  /// @return The path of the entry for a source file
+  std::filesystem::path getEntryPath(const std::filesystem::path& path) const;
+};
+
+} // namespace services
+} // namespace snowball
+
+#endif // __SNOWBALL_PRECOMPILED_CACHE_H_
@@ -0,0 +1,126 @@
+#include "ProfileService.h"
+
+#include "../constants.h"
+#include "../errors.h"
+#include "../utils/logger.h"
+#include "../utils/utils.h"
+
+#include <llvm/ProfileData/InstrProfReader.h>
+#include <llvm/ProfileData/InstrProfWriter.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace fs = std::filesystem;
+
+namespace snowball {
+namespace services {
+
+namespace {
+const char* INDEXED_PROFILE_NAME = "default.profdata";
+
+bool isProfile(const fs::path& path) { return path.extension() == ".profraw" || path.extension() == ".profdata"; }
+} // namespace
+
+fs::path ProfileService::getRawProfilePath(const fs::path& folder) {
+  // "%m" makes the profile runtime merge every run of the same executable
+  // into a single file instead of overwriting it.
+  return folder / "default-%m.profraw";
+}
+
+fs::path ProfileService::getIndexedProfile(const fs::path& path) {
+  if (!fs::exists(path)) {
+    throw SNError(
+            Error::IO_ERROR,
+            FMT("Profile not found (%s)\n%shelp%s: build with '-profile-generate' and run the program first",
+                path.c_str(),
+                BGRN,
+                RESET)
+    );
+  }
+
+  std::vector<fs::path> inputs;
+  fs::path output;
+  if (fs::is_directory(path)) {
+    output = path / INDEXED_PROFILE_NAME;
+    for (auto& entry : fs::directory_iterator(path)) {
+      if (entry.is_regular_file() && isProfile(entry.path()) && entry.path() != output) inputs.push_back(entry.path());
+    }
+  } else if (path.extension() == ".profraw") {
+    output = fs::path(path).replace_extension(".profdata");
+    inputs.push_back(path);
+  } else {
+    return path;
+  }
+
+  if (inputs.empty()) {
+    if (fs::exists(output)) return output;
+    throw SNError(
+            Error::IO_ERROR,
+            FMT("No profiles found in %s\n%shelp%s: build with '-profile-generate' and run the program first",
+                path.c_str(),
+                BGRN,
+                RESET)
+    );
+  }
+
+  bool upToDate = fs::exists(output);
+  for (auto& input : inputs) {
+    if (!upToDate) break;
+    upToDate = fs::last_write_time(input) <= fs::last_write_time(output);
+  }
+
+  if (!upToDate) {
+    DEBUG_CODEGEN("Merging %i profile(s) into %s", (int) inputs.size(), output.c_str());
+    merge(inputs, output);
+  }
+
+  return output;
+}
+
+void ProfileService::merge(const std::vector<fs::path>& inputs, const fs::path& output) {
+  llvm::InstrProfWriter writer;
+  for (auto& input : inputs) {
+    auto reader = llvm::InstrProfReader::create(input.string());
+    if (auto err = reader.takeError()) {
+      throw SNError(
+              Error::IO_ERROR,
+              FMT("Could not read profile %s: %s", input.c_str(), llvm::toString(std::move(err)).c_str())
+      );
+    }
+
+    if (auto err = writer.mergeProfileKind((*reader)->getProfileKind())) {
+      throw SNError(
+              Error::IO_ERROR,
+              FMT("Could not merge profile %s: %s", input.c_str(), llvm::toString(std::move(err)).c_str())
+      );
+    }
+
+    for (auto& record : **reader) {
+      writer.addRecord(std::move(record), 1, [&](llvm::Error err) {
+        Logger::warning(FMT("%s: %s", input.c_str(), llvm::toString(std::move(err)).c_str()));
+      });
+    }
+
+    if ((*reader)->hasError()) {
+      throw SNError(
+              Error::IO_ERROR,
+              FMT("Could not read profile %s: %s",
+                  input.c_str(),
+                  llvm::toString((*reader)->getError()).c_str())
+      );
+    }
+  }
+
+  std::error_code ec;
+  llvm::raw_fd_ostream os(output.string(), ec, llvm::sys::fs::OF_None);
+  if (ec) throw SNError(Error::IO_ERROR, FMT("Could not open file: %s", ec.message().c_str()));
+  if (auto err = writer.write(os)) {
+    throw SNError(
+            Error::IO_ERROR,
+            FMT("Could not write profile %s: %s", output.c_str(), llvm::toString(std::move(err)).c_str())
+    );
+  }
+}
+
+} // namespace services
+} // namespace snowball
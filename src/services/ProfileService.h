@@ -0,0 +1,44 @@
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifndef __SNOWBALL_PROFILE_SERVICE_H_
+#define __SNOWBALL_PROFILE_SERVICE_H_
+
+namespace snowball {
+namespace services {
+
+/**
+ * @brief Profiles used for profile guided optimization.
+ *
+ * @details
+ * Programs built with `-profile-generate` write a raw profile (`.profraw`)
+ * into the profile folder when they exit. Every run of the same executable
+ * is merged into the same raw profile by the profile runtime itself.
+ *
+ * Before optimizing with them (`-profile-use`), raw profiles are merged into
+ * a single indexed profile (`.profdata`), just like `llvm-profdata merge`
+ * would do. The indexed profile is only merged again if a raw profile changed.
+ */
+class ProfileService {
+public:
+  /// @return The file (pattern) where instrumented programs write their
+  ///  profile, inside of @param folder.
+  static std::filesystem::path getRawProfilePath(const std::filesystem::path& folder);
+  /**
+   * @brief Get the indexed profile to optimize with.
+   * @param path Either a folder containing the profiles or a single profile
+   *  (raw or indexed).
+   */
+  static std::filesystem::path getIndexedProfile(const std::filesystem::path& path);
+
+private:
+  /// @brief Merge every profile in @param inputs into the indexed profile @param output.
+  static void merge(const std::vector<std::filesystem::path>& inputs, const std::filesystem::path& output);
+};
+
+} // namespace services
+} // namespace snowball
+
+#endif // __SNOWBALL_PROFILE_SERVICE_H_
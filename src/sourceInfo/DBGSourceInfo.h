@@ -48,7 +48,7 @@ public:
    * @brief Create a new instance  of dbg source info
    * using a token as reference.
    */
-  static auto fromToken(const SourceInfo* i, Token tk) { return new DBGSourceInfo(i, tk.get_pos(), tk.get_width()); }
+  static auto fromToken(const SourceInfo* i, const Token& tk) { return new DBGSourceInfo(i, tk.get_pos(), tk.get_width()); }
 
   ~DBGSourceInfo() = delete;
 };
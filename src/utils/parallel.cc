@@ -0,0 +1,62 @@
+
+#include "parallel.h"
+
+#include "../constants.h"
+
+#include <llvm/Support/TimeProfiler.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace snowball {
+namespace utils {
+
+unsigned getJobCount(unsigned jobs) {
+  if (jobs != 0) return jobs;
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void parallelFor(std::size_t count, unsigned jobs, const std::function<void(std::size_t)>& fn) {
+  auto workers = std::min<std::size_t>(getJobCount(jobs), count);
+  if (workers <= 1) {
+    for (std::size_t i = 0; i < count; ++i) fn(i);
+    return;
+  }
+
+  std::atomic<std::size_t> next = 0;
+  std::exception_ptr error = nullptr;
+  std::mutex errorMutex;
+  // The time trace profiler is per thread, the events recorded by each
+  // worker are merged into the calling thread's profiler once it finishes.
+  bool timeTrace = llvm::timeTraceProfilerEnabled();
+
+  auto worker = [&]() {
+    if (timeTrace) llvm::timeTraceProfilerInitialize(_SNOWBALL_TIME_TRACE_GRANULARITY, "snowball");
+    while (true) {
+      auto i = next.fetch_add(1);
+      if (i >= count) break;
+      try {
+        fn(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) error = std::current_exception();
+        next = count; // stop handing out work
+      }
+    }
+    if (timeTrace) llvm::timeTraceProfilerFinishThread();
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers);
+  for (std::size_t i = 0; i < workers; ++i) threads.emplace_back(worker);
+  for (auto& t : threads) t.join();
+
+  if (error) std::rethrow_exception(error);
+}
+
+} // namespace utils
+} // namespace snowball
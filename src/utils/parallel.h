@@ -0,0 +1,26 @@
+
+#include <cstddef>
+#include <functional>
+
+#ifndef __SNOWBALL_UTILS_PARALLEL_H_
+#define __SNOWBALL_UTILS_PARALLEL_H_
+
+namespace snowball {
+namespace utils {
+
+/**
+ * @brief Call @param fn for every index in the range `[0, count)` using
+ *  (at most) @param jobs threads.
+ *
+ * @note If any of the calls throws, the first exception is rethrown once
+ *  all the workers have finished.
+ * @note A job count of `0` uses one thread per available core.
+ */
+void parallelFor(std::size_t count, unsigned jobs, const std::function<void(std::size_t)>& fn);
+/// @return The number of threads to use for a given job count.
+unsigned getJobCount(unsigned jobs);
+
+} // namespace utils
+} // namespace snowball
+
+#endif // __SNOWBALL_UTILS_PARALLEL_H_
@@ -14,6 +14,7 @@
 #endif
 
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
 
 #ifdef __APPLE__
@@ -165,5 +166,22 @@ std::string itos(int i) // convert int to string
   return s.str();
 }
 
+uint64_t hashString(const std::string& str) {
+  // 64-bit FNV-1a. It's stable across runs and platforms, which is what
+  // we need for anything that gets stored on disk.
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+std::string hashToString(uint64_t hash) {
+  std::stringstream s;
+  s << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return s.str();
+}
+
 } // namespace utils
 } // namespace snowball
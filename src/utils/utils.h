@@ -25,6 +25,10 @@ std::string getUTF8FromIndex(const std::string& s, const int index);
 std::list<std::string> split(std::string str, std::string token);
 bool endsWith(const std::string& mainStr, const std::string& toMatch);
 bool startsWith(const std::string& str, const std::string& comp);
+/// @brief Stable (non-randomized) hash of a string, safe to be stored on disk.
+uint64_t hashString(const std::string& str);
+/// @brief Hexadecimal representation of a hash, padded to 16 characters.
+std::string hashToString(uint64_t hash);
 void replaceAll(std::string& str, const std::string& from, const std::string& to);
 std::string
 getSubstringByRange(const std::string& str, const std::pair<int, int>& start, const std::pair<int, int>& end);
@@ -0,0 +1,207 @@
+#include "EscapeAnalysis.h"
+
+#include "../ir/values/Call.h"
+#include "../ir/values/Cast.h"
+#include "../ir/values/Conditional.h"
+#include "../ir/values/Dereference.h"
+#include "../ir/values/EnumInit.h"
+#include "../ir/values/Func.h"
+#include "../ir/values/IndexExtract.h"
+#include "../ir/values/ReferenceTo.h"
+#include "../ir/values/Return.h"
+#include "../ir/values/Switch.h"
+#include "../ir/values/Throw.h"
+#include "../ir/values/TryCatch.h"
+#include "../ir/values/ValueExtract.h"
+#include "../ir/values/Variable.h"
+#include "../ir/values/VariableDeclaration.h"
+#include "../ir/values/WhileLoop.h"
+#include "../ast/types/DefinedType.h"
+#include "../services/OperatorService.h"
+#include "../utils/utils.h"
+
+#define VISIT(Val) void EscapeAnalysis::visit(ir::Val* p_node)
+
+namespace snowball {
+namespace codegen {
+
+EscapeAnalysis::EscapeAnalysis(std::shared_ptr<ir::Module> mod)
+    : AcceptorExtend<EscapeAnalysis, ValueVisitor>(), module(mod) { }
+
+void EscapeAnalysis::codegen() {
+  for (auto fn : module->getFunctions()) analyze(fn.get());
+
+  // A closure environment can only live on the stack if every lambda that
+  // may reference it is known to not outlive the function. Lambdas declaring
+  // other lambdas are kept on the heap since nested closures can reach the
+  // environment of any of their parents.
+  for (auto& [fn, created] : createdLambdas) {
+    bool escapes = false;
+    for (auto lambda : created) {
+      auto nested = createdLambdas.find(lambda);
+      if (lambda->escapes() || nested == createdLambdas.end() || !nested->second.empty()) {
+        escapes = true;
+        break;
+      }
+    }
+    fn->setClosureEscapes(escapes);
+  }
+}
+
+void EscapeAnalysis::analyze(ir::Func* fn) {
+  auto body = fn->getBody();
+  if (!body || createdLambdas.count(fn)) return;
+
+  lambdas.clear();
+  boundLambdas.clear();
+  escapingLambdas.clear();
+  escapingVariables.clear();
+  movedVariables.clear();
+  ownerVariables.clear();
+
+  if (fn->superCall) visitValue(fn->superCall);
+  visitValue(body);
+
+  for (auto lambda : lambdas) {
+    bool escapes = escapingLambdas.count(lambda);
+    if (auto it = boundLambdas.find(lambda); it != boundLambdas.end()) {
+      auto variable = it->second;
+      escapes = escapes || variable->isUsedInLambda() || escapingVariables.count(variable);
+    }
+    lambda->setEscapes(escapes);
+  }
+
+  for (auto variable : ownerVariables)
+    variable->setNeedsDrop(!variable->isUsedInLambda() && !movedVariables.count(variable));
+
+  createdLambdas[fn] = lambdas;
+}
+
+void EscapeAnalysis::visitValue(std::shared_ptr<ir::Value> value, Position pos) {
+  if (!value) return;
+  auto backup = position;
+  position = pos;
+  value->visit(this);
+  position = backup;
+}
+
+bool EscapeAnalysis::createsObject(std::shared_ptr<ir::Value> value, types::Type* type) {
+  if (!utils::is<types::DefinedType>(type)) return false;
+  if (utils::is<ir::ObjectInitialization>(value.get())) return true;
+  // Static functions returning their own type are treated as constructors
+  // (e.g. `Vector::with_capacity`)
+  if (auto call = utils::dyn_cast<ir::Call>(value)) {
+    auto fn = utils::dyn_cast<ir::Func>(call->getCallee());
+    return fn && fn->isStatic() && fn->hasParent() && fn->getParent()->is(type) && fn->getRetTy()->is(type);
+  }
+
+  return false;
+}
+
+bool EscapeAnalysis::isOwnerReassignment(ir::Call* call) {
+  auto fn = utils::dyn_cast<ir::Func>(call->getCallee());
+  if (!fn || !fn->hasAttribute(Attributes::BUILTIN)) return false;
+  if (!services::OperatorService::opEquals<services::OperatorService::EQ>(fn->getName(true))) return false;
+  auto args = call->getArguments();
+  if (args.size() != 2) return false;
+  auto extract = utils::dyn_cast<ir::ValueExtract>(args.at(0));
+  return extract && utils::is<ir::Variable>(extract->getValue().get()) && createsObject(args.at(1), args.at(0)->getType());
+}
+
+VISIT(Func) {
+  // Other function bodies are analyzed on their own
+  if (!p_node->isAnon()) return;
+  lambdas.push_back(p_node);
+  if (position != Position::Callee) escapingLambdas.insert(p_node);
+}
+
+VISIT(Block) {
+  for (auto i : p_node->getBlock()) visitValue(i);
+}
+
+VISIT(StringValue) { /* noop */ }
+VISIT(NumberValue) { /* noop */ }
+VISIT(BooleanValue) { /* noop */ }
+VISIT(FloatValue) { /* noop */ }
+VISIT(CharValue) { /* noop */ }
+VISIT(EnumInit) { /* noop */ }
+VISIT(LoopFlow) { /* noop */ }
+VISIT(Argument) { /* noop */ }
+
+VISIT(Variable) {
+  if (position != Position::Callee) escapingVariables.insert(p_node);
+  if (position == Position::Value) movedVariables.insert(p_node);
+}
+
+VISIT(ValueExtract) {
+  // Keep the position, calling an extracted value is still a call
+  visitValue(p_node->getValue(), position);
+}
+
+VISIT(Call) {
+  if (utils::is<ir::ZeroInitialized>(p_node)) return;
+  if (auto init = utils::cast<ir::ObjectInitialization>(p_node)) visitValue(init->createdObject);
+  else if (!utils::is<ir::EnumInit>(p_node->getCallee().get())) visitValue(p_node->getCallee(), Position::Callee);
+
+  auto args = p_node->getArguments();
+  if (isOwnerReassignment(p_node)) {
+    // Assigning a new object to a variable doesn't move the old one out of
+    // it, it gets destroyed and the variable owns the new one.
+    visitValue(args.at(0), Position::Borrow);
+    visitValue(args.at(1));
+    return;
+  }
+
+  for (auto a : args) visitValue(a);
+}
+
+VISIT(Return) { visitValue(p_node->getExpr()); }
+
+VISIT(Throw) { visitValue(p_node->getExpr()); }
+
+VISIT(Cast) { visitValue(p_node->getExpr()); }
+
+VISIT(ReferenceTo) { visitValue(p_node->getValue(), Position::Borrow); }
+
+VISIT(DereferenceTo) { visitValue(p_node->getValue()); }
+
+// Reading a field doesn't move the object itself
+VISIT(IndexExtract) { visitValue(p_node->getValue(), Position::Borrow); }
+
+VISIT(VariableDeclaration) {
+  auto value = p_node->getValue();
+  if (auto fn = utils::dyn_cast<ir::Func>(value); fn && fn->isAnon()) {
+    lambdas.push_back(fn.get());
+    boundLambdas[fn.get()] = p_node->getVariable().get();
+    return;
+  }
+
+  if (createsObject(value, p_node->getType())) ownerVariables.push_back(p_node->getVariable().get());
+  visitValue(value);
+}
+
+VISIT(WhileLoop) {
+  visitValue(p_node->getCondition());
+  visitValue(p_node->getBlock());
+  visitValue(p_node->getForCond());
+}
+
+VISIT(Conditional) {
+  visitValue(p_node->getCondition());
+  visitValue(p_node->getBlock());
+  visitValue(p_node->getElse());
+}
+
+VISIT(TryCatch) {
+  visitValue(p_node->getBlock());
+  for (auto c : p_node->getCatchBlocks()) visitValue(c);
+}
+
+VISIT(Switch) {
+  visitValue(p_node->getExpr());
+  for (auto c : p_node->getCases()) visitValue(c.block);
+  visitValue(p_node->getDefaultCase());
+}
+
+} // namespace codegen
+} // namespace snowball
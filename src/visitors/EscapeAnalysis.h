@@ -0,0 +1,101 @@
+
+#include "../ValueVisitor/Visitor.h"
+#include "../ir/module/Module.h"
+#include "../ir/values/Value.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+#ifndef __SNOWBALL_ESCAPE_ANALYSIS_H_
+#define __SNOWBALL_ESCAPE_ANALYSIS_H_
+
+namespace snowball {
+namespace codegen {
+
+/**
+ * @brief EscapeAnalysis class
+ *
+ * Decides, for every allocation site the code generator would otherwise
+ * heap allocate, if the allocation can live on the stack of the function
+ * creating it instead. This currently covers lambda contexts and closure
+ * environments (objects are already value types and get allocated on the
+ * stack).
+ *
+ * A lambda doesn't escape if it's only ever called: either directly or
+ * through a local variable that is never used for anything else than being
+ * called. A closure environment doesn't escape if none of the lambdas
+ * declared inside its function escape or declare lambdas themselves.
+ *
+ * The analysis is conservative, anything it can't prove keeps being heap
+ * allocated (e.g. lambdas passed as arguments, returned or stored).
+ *
+ * It also decides which local variables own their object and have to
+ * destroy it once they go out of scope. A variable owns an object created
+ * for it (`new T(...)` or a static `T` function returning `T`) as long as
+ * the object never leaves the variable: it may only be borrowed (e.g. by
+ * calling methods on it or taking a reference to it). Using the variable
+ * by value (returning it, passing it as an argument, copying it) moves the
+ * object and the variable stops owning it. Assigning a new object to the
+ * variable destroys the old one and keeps the ownership.
+ */
+class EscapeAnalysis : public AcceptorExtend<EscapeAnalysis, codegen::ValueVisitor> {
+  // Program represented by a module.
+  std::shared_ptr<ir::Module> module;
+  /// @brief How the value being visited is used by its parent
+  enum class Position
+  {
+    Value,
+    Callee,
+    Borrow
+  } position = Position::Value;
+
+  // Lambdas created inside the function being analyzed
+  std::vector<ir::Func*> lambdas;
+  // Lambdas that are directly bound to a local variable
+  std::map<ir::Func*, ir::Variable*> boundLambdas;
+  // Lambdas used as a value (e.g. returned, passed as argument)
+  std::set<ir::Func*> escapingLambdas;
+  // Variables used for something else than being called
+  std::set<ir::Variable*> escapingVariables;
+  // Variables whose value is moved out of them
+  std::set<ir::Variable*> movedVariables;
+  // Variables initialized with an object created for them
+  std::vector<ir::Variable*> ownerVariables;
+  // Lambdas created inside each analyzed function
+  std::map<ir::Func*, std::vector<ir::Func*>> createdLambdas;
+
+  /// @brief Analyze a single function body
+  void analyze(ir::Func* fn);
+  /// @brief Visit a value used in the given position
+  void visitValue(std::shared_ptr<ir::Value> value, Position pos = Position::Value);
+  /// @return true if the value creates a new object owned by whoever stores it
+  bool createsObject(std::shared_ptr<ir::Value> value, types::Type* type);
+  /// @return true if the call assigns a new object to a local variable
+  bool isOwnerReassignment(ir::Call* call);
+
+public:
+  EscapeAnalysis(std::shared_ptr<ir::Module> mod);
+  ~EscapeAnalysis() noexcept = default;
+
+  /**
+   * @brief Start the analysis
+   *
+   * It must run after the type checker, since it relies on the
+   * variables being marked as used inside lambdas.
+   */
+  void codegen() override;
+
+private:
+  void visit(ir::Value* v) { v->visit(this); }
+
+#define VISIT(n) void visit(ir::n*) override;
+#include "../defs/visits.def"
+#undef VISIT
+};
+
+} // namespace codegen
+} // namespace snowball
+
+#undef VISIT
+#endif // __SNOWBALL_ESCAPE_ANALYSIS_H_
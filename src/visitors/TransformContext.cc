@@ -46,7 +46,7 @@ std::shared_ptr<transform::ContextState> TransformContext::saveState() {
   auto s = this->stack;
   s.pop_back();
 
-  return std::make_shared<transform::ContextState>(s, this->module, this->uuidStack, this->currentClass);
+  return std::make_shared<transform::ContextState>(std::move(s), this->module, this->uuidStack, this->currentClass);
 }
 
 /// @brief set a state to the current context
@@ -55,7 +55,7 @@ void TransformContext::setState(std::shared_ptr<transform::ContextState> s) {
   auto st = s->stack;
   st.emplace_back(glob);
 
-  this->stack = st;
+  this->stack = std::move(st);
   this->module = s->module;
   this->uuidStack = s->uuidStack;
   this->builder.setModule(s->module);
@@ -12,7 +12,10 @@
 #include "TransformItem.h"
 
 #include <assert.h>
+#include <map>
 #include <string>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 #ifndef __SNOWBALL_TRANSFORM_CONTEXT_H_
@@ -34,6 +37,9 @@ class TransformContext : public AcceptorExtend<TransformContext, ASTContext<tran
   ir::IRBuilder builder;
   /// @brief A map containing all core interfaces
   std::unordered_map<std::string, types::InterfaceType*> coreInterfaces = {};
+  /// @brief Primitive number types built so far, keyed by (is float, bits, is signed).
+  ///  It only caches their construction (see `getPrimitiveNumberType`).
+  std::map<std::tuple<bool, int, bool>, types::Type*> primitiveNumberTypeCache = {};
 
 public:
   // Module given to us so we can
@@ -87,13 +93,21 @@ public:
   );
   /**
    * @brief Get a primitive number type
+   * @note The type and its core interfaces are only looked up and built
+   *  once, but every call still returns a new copy of it. Types are not
+   *  interned: the transformer modifies them in place (e.g. when they are
+   *  marked as mutable), so they can't be shared and they are compared
+   *  structurally (see `Type::is`).
    */
   template <typename T, typename... Ts>
   auto getPrimitiveNumberType(int bits, Ts&&... args) {
-    T* ty = new T(bits, std::forward<Ts>(args)...);
-    ty->addImpl(getBuiltinTypeImpl("Sized"));
-    ty->addImpl(getBuiltinTypeImpl("Numeric"));
-    return ty;
+    auto& cached = primitiveNumberTypeCache[{std::is_same_v<T, types::FloatType>, bits, (true && ... && args)}];
+    if (cached == nullptr) {
+      cached = new T(bits, std::forward<Ts>(args)...);
+      cached->addImpl(getBuiltinTypeImpl("Sized"));
+      cached->addImpl(getBuiltinTypeImpl("Numeric"));
+    }
+    return static_cast<T*>(cached->copy());
   }
   // clang-format off
   /// @brief Get the bool primitive type
@@ -1,8 +1,10 @@
 #include "../ir/module/Module.h"
 #include "TransformItem.h"
 
+#include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #ifndef __SNOWBALL_TRANSFORM_STATE_H_
@@ -13,8 +15,10 @@ namespace Syntax {
 namespace transform {
 
 /// @brief Representation of a saved state for the context
+/// @note Scopes are shared with the context they were saved from, the
+///  context copies a scope before modifying it (see ASTContext).
 struct ContextState : std::enable_shared_from_this<ContextState> {
-  using StackType = std::list<std::map<std::string, std::shared_ptr<Item>>>;
+  using StackType = std::list<std::shared_ptr<std::unordered_map<std::string, std::shared_ptr<Item>>>>;
   StackType stack = {};
   std::shared_ptr<ir::Module> module = nullptr;
   types::Type* currentClass = nullptr;
@@ -26,7 +30,7 @@ struct ContextState : std::enable_shared_from_this<ContextState> {
           std::vector<std::string> uuidStack,
           types::Type* currentClass = nullptr
   )
-      : stack(s), module(module), currentClass(currentClass), uuidStack(uuidStack) { }
+      : stack(std::move(s)), module(module), currentClass(currentClass), uuidStack(uuidStack) { }
 };
 } // namespace transform
 } // namespace Syntax
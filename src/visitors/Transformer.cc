@@ -67,6 +67,10 @@ std::shared_ptr<ir::Value> Transformer::trans(Node* node) {
 }
 
 std::vector<std::shared_ptr<ir::Module>> Transformer::getModules() const { return modules; }
+std::map<std::filesystem::path, std::set<std::filesystem::path>> Transformer::getDependencyGraph() const {
+  return ctx->imports->cache->getDependencies();
+}
+services::ImportService* Transformer::getImportService() const { return ctx->imports.get(); }
 void Transformer::addModule(std::shared_ptr<ir::Module> m) {
   ctx->cache->addModule(m->getUniqueName(), m);
   modules.push_back(m);
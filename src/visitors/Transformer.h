@@ -27,8 +27,12 @@
 
 #include <assert.h>
 #include <deque>
+#include <filesystem>
+#include <map>
 #include <memory>
+#include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #ifndef __SNOWBALL_TRANSFORM_H_
@@ -83,6 +87,23 @@ class Transformer : public AcceptorExtend<Transformer, Visitor> {
   TransformContext* ctx;
   // Transformed value from the last call
   std::shared_ptr<ir::Value> value;
+  /// @brief What identifies a call for `getBestFittingFunction`: the overload
+  ///  set, the argument types and the explicit generics.
+  struct BestFittingKey {
+    bool isIdentifier;
+    std::vector<std::pair<const void*, const void*>> overloads;
+    std::vector<types::Type*> arguments;
+    std::vector<types::Type*> generics;
+
+    /// @note Types are compared by identity (see `types::Type::is`) and mutability.
+    bool operator==(const BestFittingKey& other) const;
+    struct Hash {
+      std::size_t operator()(const BestFittingKey& key) const;
+    };
+  };
+  /// @brief Overloads already chosen by `getBestFittingFunction`.
+  std::unordered_map<BestFittingKey, std::pair<Cache::FunctionStore, std::vector<types::Type*>>, BestFittingKey::Hash>
+          bestFittingFunctions;
   /**
    * Function fetch response.
    *
@@ -170,6 +191,7 @@ class Transformer : public AcceptorExtend<Transformer, Visitor> {
    * if it was already generated, we can just return the already
    * generated function.
    *  @c deduceFunction
+   * @note Successful resolutions are cached, see `bestFittingFunctions`.
    */
   std::tuple<Cache::FunctionStore, std::vector<types::Type*>, FunctionFetchResponse> getBestFittingFunction(
           const std::deque<Cache::FunctionStore>& overloads,
@@ -177,6 +199,13 @@ class Transformer : public AcceptorExtend<Transformer, Visitor> {
           const std::vector<Expression::TypeRef*>& generics = {},
           bool isIdentifier = false
   );
+  /// @brief Overload resolution behind `getBestFittingFunction`, without any caching.
+  std::tuple<Cache::FunctionStore, std::vector<types::Type*>, FunctionFetchResponse> findBestFittingFunction(
+          const std::deque<Cache::FunctionStore>& overloads,
+          const std::vector<types::Type*>& arguments,
+          const std::vector<types::Type*>& genericArguments,
+          bool isIdentifier
+  );
   /**
    * It tries to check if a type can be "casted" into another type.
    * @note It will return CastType::None if the types are not compatible.
@@ -550,6 +579,10 @@ public:
   );
   /// @return a list of generated modules through the whole project
   std::vector<std::shared_ptr<ir::Module>> getModules() const;
+  /// @return the files imported by each source file used through the whole project
+  std::map<std::filesystem::path, std::set<std::filesystem::path>> getDependencyGraph() const;
+  /// @return the service used to resolve (and cache) the imported modules
+  services::ImportService* getImportService() const;
 
 #include "../defs/accepts.def"
 
@@ -341,6 +341,20 @@ VISIT(Cast) {
     }
   }
 
+  // we also allow "*x to u64" (reading the address of a pointer), but only into
+  // pointer sized integers since narrower ones would silently truncate it.
+  if (utils::is<types::PointerType>(v->getType()) && utils::is<types::IntType>(t)) {
+    if (utils::cast<types::IntType>(t)->getBits() != 64) {
+      E<TYPE_ERROR>(
+              p_node,
+              FMT("Cant cast pointer type '%s' to '%s'!", v->getType()->getPrettyName().c_str(), t->getPrettyName().c_str()),
+              {.info = "Pointers can only be cast to pointer sized integers",
+               .help = "Cast it to 'usize', 'u64' or 'i64' instead."}
+      );
+    }
+    return;
+  }
+
   // we also allow "&x to *x"
   if (utils::cast<types::ReferenceType>(v->getType()) && utils::cast<types::PointerType>(t)) {
     if (utils::cast<types::ReferenceType>(v->getType())
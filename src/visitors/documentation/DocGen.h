@@ -17,6 +17,10 @@
 #define ACCEPT(Node)          virtual void visit(Node* p_node) override;
 #define SN_DOCGEN_VISIT(Node) void DocGen::visit(Node* p_node)
 
+/// @brief Version of the generated pages. It must be bumped whenever the
+///  templates change, so that pages from previous runs are generated again.
+#define _SNOWBALL_DOCS_TEMPLATE_VERSION "1"
+
 namespace snowball {
 namespace Syntax {
 
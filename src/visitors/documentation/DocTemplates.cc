@@ -8,7 +8,8 @@ namespace snowball {
 namespace Syntax {
 namespace docgen {
 
-static std::unordered_map<std::string, int> nameCount;
+// Modules are documented concurrently, each thread keeps its own count
+static thread_local std::unordered_map<std::string, int> nameCount;
 #define GO_BACK_TEXT "&lt; Go Back"
 
 #define GENERATE_TOP_LEVEL_NODES(nodes) \
@@ -37,6 +37,8 @@ void Transformer::executeGenericTests(Expression::WhereClause* clause, types::Ty
       if (!found) {
         if ((utils::is<types::IntType>(generic) || utils::is<types::FloatType>(generic)) && (interface->getUUID() == (ctx->imports->CORE_UUID + "std.ToString:0"))) { // note: Make sure to always match the UUID
           found = true;
+        } else if ((utils::is<types::IntType>(generic) || utils::is<types::FloatType>(generic)) && (interface->getUUID() == (ctx->imports->CORE_UUID + "std.Hash:0"))) { // note: Implemented by IntegerImpl
+          found = true;
         }
       }
       if (!found) {
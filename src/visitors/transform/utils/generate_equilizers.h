@@ -8,6 +8,7 @@
               OperatorService::getOperatorMangle(OperatorType::EQ), Statement::Privacy::Status::PUBLIC                 \
       );                                                                                                               \
       fn->addAttribute(Attributes::BUILTIN);                                                                           \
+      fn->setDeclarationIndex(Statement::FunctionDef::GENERATED_DECLARATION_INDEX + allowPointer);                     \
       fn->setArgs({new Expression::Param(                                                                              \
               "other", allowPointer ? transformedType->getReferenceTo()->toRef() : transformedType->toRef()            \
       )});                                                                                                             \
@@ -6,21 +6,120 @@ using namespace snowball::Syntax::transform;
 namespace snowball {
 namespace Syntax {
 
+namespace {
+void hashCombine(std::size_t& hash, std::size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); }
+
+/// @return A hash of what identifies a type: its UUID (or name) and
+///  generics, and the mutability of every pointer or reference level.
+std::size_t typeHash(types::Type* ty) {
+  std::size_t hash = ty->isMutable();
+  if (auto pointer = utils::cast<types::PointerType>(ty)) {
+    hashCombine(hash, 1);
+    hashCombine(hash, typeHash(pointer->getPointedType()));
+  } else if (auto reference = utils::cast<types::ReferenceType>(ty)) {
+    hashCombine(hash, 2);
+    hashCombine(hash, typeHash(reference->getPointedType()));
+  } else if (auto fn = utils::cast<types::FunctionType>(ty)) {
+    hashCombine(hash, 3 + fn->isVariadic());
+    for (auto arg : fn->getArgs()) hashCombine(hash, typeHash(arg));
+    hashCombine(hash, typeHash(fn->getRetType()));
+  } else if (auto base = utils::cast<types::BaseType>(ty)) {
+    hashCombine(hash, std::hash<std::string>()(base->getUUID()));
+    for (auto generic : base->getGenerics()) hashCombine(hash, typeHash(generic));
+  } else {
+    hashCombine(hash, std::hash<std::string>()(ty->getName()));
+  }
+  return hash;
+}
+
+bool sameType(types::Type* a, types::Type* b) {
+  if (a->isMutable() != b->isMutable() || !a->is(b)) return false;
+  if (auto pointer = utils::cast<types::PointerType>(a))
+    return sameType(pointer->getPointedType(), utils::cast<types::PointerType>(b)->getPointedType());
+  if (auto reference = utils::cast<types::ReferenceType>(a))
+    return sameType(reference->getPointedType(), utils::cast<types::ReferenceType>(b)->getPointedType());
+  return true;
+}
+
+bool sameTypes(const std::vector<types::Type*>& a, const std::vector<types::Type*>& b) {
+  if (a.size() != b.size()) return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (!sameType(a[i], b[i])) return false;
+  }
+  return true;
+}
+
+std::vector<types::Type*> copyTypes(const std::vector<types::Type*>& types) {
+  return utils::vector_iterate<types::Type*, types::Type*>(types, [](auto t) { return t->copy(); });
+}
+} // namespace
+
+bool Transformer::BestFittingKey::operator==(const BestFittingKey& other) const {
+  return isIdentifier == other.isIdentifier && overloads == other.overloads && sameTypes(arguments, other.arguments) &&
+         sameTypes(generics, other.generics);
+}
+
+std::size_t Transformer::BestFittingKey::Hash::operator()(const BestFittingKey& key) const {
+  std::size_t hash = key.isIdentifier;
+  for (auto [function, state] : key.overloads) {
+    hashCombine(hash, std::hash<const void*>()(function));
+    hashCombine(hash, std::hash<const void*>()(state));
+  }
+  for (auto arg : key.arguments) hashCombine(hash, typeHash(arg));
+  hashCombine(hash, key.generics.size());
+  for (auto generic : key.generics) hashCombine(hash, typeHash(generic));
+  return hash;
+}
+
 std::tuple<Cache::FunctionStore, std::vector<types::Type*>, Transformer::FunctionFetchResponse>
 Transformer::getBestFittingFunction(
         const std::deque<Cache::FunctionStore>& overloads,
         const std::vector<types::Type*>& arguments,
         const std::vector<Expression::TypeRef*>& generics,
         bool isIdentifier
+) {
+  // Explicit generics are only transformed if there's a candidate to give
+  // them to, so that calls with the wrong arity keep their diagnostic.
+  if (!isIdentifier && std::none_of(overloads.begin(), overloads.end(), [&](const auto& n) {
+        return ir::Func::argumentSizesEqual(n.function->getArgs(), arguments, n.function->isVariadic());
+      })) {
+    return {{nullptr}, {}, FunctionFetchResponse::NoMatchesFound};
+  }
+
+  auto genericArguments = utils::vector_iterate<Expression::TypeRef*, types::Type*>(generics, [&](auto g) {
+    return transformType(g);
+  });
+  // The same overload set called with the same types always resolves to the
+  // same function. Adding an overload changes the set (and thus the key).
+  BestFittingKey key = {isIdentifier, {}, arguments, genericArguments};
+  for (const auto& n : overloads) key.overloads.push_back({n.function, n.state.get()});
+
+  if (auto cached = bestFittingFunctions.find(key); cached != bestFittingFunctions.end()) {
+    // Types can be modified in place by the caller, never share them.
+    return {cached->second.first, copyTypes(cached->second.second), FunctionFetchResponse::Ok};
+  }
+
+  auto result = findBestFittingFunction(overloads, arguments, genericArguments, isIdentifier);
+  if (std::get<2>(result) == FunctionFetchResponse::Ok) {
+    key.arguments = copyTypes(arguments);
+    key.generics = copyTypes(genericArguments);
+    bestFittingFunctions[key] = {std::get<0>(result), copyTypes(std::get<1>(result))};
+  }
+  return result;
+}
+
+std::tuple<Cache::FunctionStore, std::vector<types::Type*>, Transformer::FunctionFetchResponse>
+Transformer::findBestFittingFunction(
+        const std::deque<Cache::FunctionStore>& overloads,
+        const std::vector<types::Type*>& arguments,
+        const std::vector<types::Type*>& genericArguments,
+        bool isIdentifier
 ) {
   std::vector<std::pair<Cache::FunctionStore, std::vector<types::Type*>>> functions;
   std::vector<int> importances;
   for (auto n : overloads) {
     auto fn = n.function;
     if (ir::Func::argumentSizesEqual(fn->getArgs(), arguments, fn->isVariadic()) || isIdentifier) {
-      auto genericArguments = utils::vector_iterate<Expression::TypeRef*, types::Type*>(generics, [&](auto g) {
-        return transformType(g);
-      });
       auto [deducedArgs, errors, importance] = deduceFunction(n, arguments, genericArguments);
       if (errors.empty()) {
         functions.push_back({n, deducedArgs});
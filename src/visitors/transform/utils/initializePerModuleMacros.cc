@@ -66,6 +66,16 @@ void Transformer::initializePerModuleMacros() {
   auto envInstance = new transform::MacroInstance(envMacro, ctx->module);
   auto envMacroItem = std::make_shared<transform::Item>(envInstance);
   ctx->addItem("env_var", envMacroItem);
+
+  auto hashMacro = N<Macro>(
+          "hash",
+          std::vector<std::tuple<std::string, Macro::ArguementType, Node*>>{
+                  {"value", Macro::ArguementType::EXPRESSION, nullptr}},
+          nullptr
+  );
+  auto hashInstance = new transform::MacroInstance(hashMacro, ctx->module);
+  auto hashMacroItem = std::make_shared<transform::Item>(hashInstance);
+  ctx->addItem("hash", hashMacroItem);
 }
 
 } // namespace Syntax
@@ -1,5 +1,7 @@
 #include "../../Transformer.h"
 
+#include <llvm/Support/TimeProfiler.h>
+
 using namespace snowball::utils;
 using namespace snowball::Syntax::transform;
 
@@ -13,6 +15,7 @@ types::BaseType* Transformer::transformClass(
 ) {
   auto ty = utils::cast<Statement::DefinedTypeDef>(classStore.type);
   assert(ty);
+  llvm::TimeTraceScope timeScope("TransformClass", [&] { return ty->getName(); });
   // These are the generics generated outside of the class context.
   // for example, this "Test" type woudn't be fetched inside the class
   // context:
@@ -1,5 +1,7 @@
 #include "../../Transformer.h"
 
+#include <llvm/Support/TimeProfiler.h>
+
 using namespace snowball::utils;
 using namespace snowball::Syntax::transform;
 
@@ -15,8 +17,17 @@ std::shared_ptr<ir::Func> Transformer::transformFunction(
   auto node = fnStore.function;
   bool dontAddToModule = false;
 
+  // A deferred method can be requested through more than one class (its own one
+  // and the ones inheriting it), but its declaration must only be transformed once
+  // per class it's declared in. Each instance of a generic class has its own state.
+  auto parentClass = fnStore.state ? fnStore.state->currentClass : nullptr;
+  if (!node->isGeneric()) {
+    if (auto fn = ctx->cache->getTransformedDeclaration(node, parentClass)) return fn;
+  }
+
   // get the function name and store it for readability
   auto name = node->getName();
+  llvm::TimeTraceScope timeScope("TransformFunction", [&] { return name; });
 
   // Cast the function into a bodied one, if it's not bodied,
   // we will get nullptr as a result.
@@ -56,6 +67,7 @@ std::shared_ptr<ir::Func> Transformer::transformFunction(
               node->isVariadic()
       );
       fn->setScopeIndex(ctx->getScopeIndex());
+      fn->setDeclarationIndex(node->getDeclarationIndex());
       fn->setParent(ctx->getCurrentClass());
       fn->setRetTy(returnType);
       fn->setPrivacy(node->getPrivacy());
@@ -181,6 +193,7 @@ std::shared_ptr<ir::Func> Transformer::transformFunction(
     if (dontAddToModule) return;
     ctx->module->addFunction(fn);
   });
+  if (!node->isGeneric()) ctx->cache->setTransformedDeclaration(node, parentClass, fn);
   return fn;
 }
 
@@ -121,6 +121,32 @@ void Transformer::transformMacro(Expression::PseudoVariable* p_node, MacroInstan
     this->value = getBuilder().createNumberValue(p_node->getDBGInfo(), tr->alignmentOf()/8);
     this->value->setDBGInfo(p_node->getDBGInfo());
     this->value->setType(ctx->getInt32Type());
+  } else if (macroName == "hash") {
+    // Types implementing `Hash` (numbers included) get hashed with it. Hash based
+    // containers require it as a bound, so other types are an error.
+    auto expr = utils::cast<Expression::Base>(args.at(0));
+    auto type = trans(expr)->getType();
+    if (auto x = utils::cast<types::ReferenceType>(type)) type = x->getPointedType();
+    bool hashable = utils::is<types::IntType>(type) || utils::is<types::FloatType>(type);
+    for (auto impl : type->getImpls()) {
+      if (impl->getUUID() == (ctx->imports->CORE_UUID + "std.Hash:0")) { // note: Make sure to always match the UUID
+        hashable = true;
+        break;
+      }
+    }
+    if (!hashable) {
+      E<TYPE_ERROR>(p_node, FMT("Type '%s' does not implement 'Hash'", type->getPrettyName().c_str()), {
+        .info = "This value can't be hashed",
+        .help = FMT("Implement 'Hash' for '%s'", type->getPrettyName().c_str()),
+      });
+    }
+    auto ident = Syntax::N<Expression::Identifier>("hash");
+    auto index = Syntax::N<Expression::Index>(expr, ident);
+    auto call = Syntax::N<Expression::FunctionCall>(index, std::vector<Expression::Base*>());
+    ident->setDBGInfo(p_node->getDBGInfo());
+    index->setDBGInfo(p_node->getDBGInfo());
+    call->setDBGInfo(p_node->getDBGInfo());
+    this->value = trans(call);
   } else if (macroName == "include_str") {
     auto str = utils::cast<Expression::ConstantValue>(args.at(0));
     auto filename = str->getValue();
@@ -25,6 +25,7 @@ SN_TRANSFORMER_VISIT(Expression::LambdaFunction) {
   fn->setParent(ctx->getCurrentClass());
   fn->setParentScope(ctx->getCurrentFunction());
   fn->setScopeIndex(ctx->getScopeIndex());
+  fn->setDeclarationIndex(node->getDeclarationIndex());
   fn->setRetTy(returnType);
   fn->setPrivacy(Statement::Privacy::PRIVATE);
   fn->setStatic(false);
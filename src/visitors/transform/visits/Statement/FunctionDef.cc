@@ -109,7 +109,25 @@ SN_TRANSFORMER_VISIT(Statement::FunctionDef) {
     return;
   }
 
-  if (ctx->generateFunction && !p_node->isGeneric()) transformFunction({p_node, state}, {});
+  if (ctx->generateFunction && !p_node->isGeneric()) {
+    // Functions and methods from external packages (e.g. the standard library) are only
+    // transformed once they get referenced (see `getFunction`), the same way generic
+    // functions are. This way, unused functions are never type checked nor generated.
+    // Exported functions can be called from outside snowball's code, so they always
+    // get generated.
+    bool isLazy = !ctx->isMainModule && !p_node->isExtern() && !p_node->hasAttribute(Attributes::EXPORT) &&
+            !p_node->hasAttribute(Attributes::NO_MANGLE);
+    if (auto c = ctx->getCurrentClass(true)) {
+      // The virtual table of a class is filled while its methods get transformed and
+      // destructors are called by the code generator itself, so those are never deferred.
+      // Constructors are kept too, a class is rarely imported without being created.
+      auto defined = utils::cast<types::DefinedType>(c);
+      isLazy = isLazy && defined != nullptr && !defined->hasVtable && !p_node->isVirtual() &&
+              !services::OperatorService::opEquals<services::OperatorService::CONSTRUCTOR>(name) &&
+              !services::OperatorService::opEquals<services::OperatorService::DESTRUCTOR>(name);
+    }
+    if (!isLazy) transformFunction({p_node, state}, {});
+  }
 }
 
 } // namespace Syntax
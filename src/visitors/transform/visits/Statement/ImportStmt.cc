@@ -7,6 +7,7 @@
 #include "../../../analyzers/DefinitveAssigment.h"
 
 #include <fstream>
+#include <llvm/Support/TimeProfiler.h>
 #include <tuple>
 
 using namespace snowball::utils;
@@ -23,6 +24,7 @@ SN_TRANSFORMER_VISIT(Statement::ImportStmt) {
   // TODO: extension
   auto [filePath, originalPath, error] = ctx->imports->getImportPath(package, path);
   if (!error.empty()) { E<IMPORT_ERROR>(p_node, error); }
+  ctx->imports->cache->addDependency(getSourceInfo()->getPath(), filePath);
   // TODO: don't allow user import std::std twice!
   auto uuid = package == "std" ? ctx->imports->CORE_UUID + utils::join(path.begin(), path.end(), ".") : ctx->imports->getModuleUUID(filePath);
   auto exportName = ctx->imports->getExportName(originalPath, p_node->getExportSymbol());
@@ -56,6 +58,7 @@ SN_TRANSFORMER_VISIT(Statement::ImportStmt) {
     // clang-format off
     ctx->withState(state,
       [filePath = filePath, mod, this]() mutable {
+      llvm::TimeTraceScope importScope("Import", filePath.string());
       std::ifstream ifs(filePath.string());
       assert(!ifs.fail());
       std::string content((std::istreambuf_iterator<char>(ifs)),
@@ -63,24 +66,16 @@ SN_TRANSFORMER_VISIT(Statement::ImportStmt) {
       const SourceInfo* srcInfo = new SourceInfo(content, filePath);
       auto backupSourceInfo = getSourceInfo();
       setSourceInfo(srcInfo);
-      auto lexer = new Lexer(srcInfo);
-#if _SNOWBALL_TIMERS_DEBUG
-      DEBUG_TIMER("Lexer: %fs (%s)", utils::_timer([&] {
-          lexer->tokenize();
-      }), filePath.c_str());
-#else
-      lexer->tokenize();
-#endif
-      auto tokens = lexer->tokens;
-      if (tokens.size() != 0) {
+      {
         auto backupModule = ctx->module;
         ctx->module = mod;
-        auto parser = new parser::Parser(tokens, srcInfo);
-#if _SNOWBALL_TIMERS_DEBUG
         parser::Parser::NodeVec ast;
-        DEBUG_TIMER("Parser: %fs (%s)", utils::_timer([&] { ast = parser->parse(); }), filePath.c_str());
+#if _SNOWBALL_TIMERS_DEBUG
+        DEBUG_TIMER("Parser: %fs (%s)", utils::_timer([&] {
+            ast = ctx->imports->precompiled->parse(srcInfo);
+        }), filePath.c_str());
 #else
-        auto ast = parser->parse();
+        ast = ctx->imports->precompiled->parse(srcInfo);
 #endif
         ctx->module->setSourceInfo(srcInfo);
         visitGlobal(ast);
@@ -36,7 +36,7 @@ SN_TRANSFORMER_VISIT(Statement::VariableDecl) {
     }
   }
 
-  if (ctx->getInScope(variableName, ctx->currentScope()).second) {
+  if (ctx->getInCurrentScope(variableName).second) {
     E<VARIABLE_ERROR>(
             p_node,
             FMT("Variable with name '%s' is already "